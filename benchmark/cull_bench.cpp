@@ -0,0 +1,211 @@
+//frustum culling microbenchmark, built from src/utils/FrustumCulling.cpp, src/utils/Bvh.cpp and src/utils/ThreadPool.cpp plus this file
+//random spheres around a perspective camera, prints objects culled per millisecond for the scalar, simd, threaded simd and bvh paths,
+//bvh build/refit/raycast times, and fails if any result differs from the scalar (or brute force raycast) one
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "utils/Bvh.h"
+#include "utils/FrustumCulling.h"
+#include "utils/ThreadPool.h"
+
+//best of iterations runs, in milliseconds
+template<typename Func>
+static double timeBest(uint32_t iterations, Func&& func)
+{
+    double best = 1e30;
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+//the reference Bvh::raycast has to match, nearest hit with ties going to the lowest index
+static bool raycastBruteForce(const std::vector<glm::vec4>& spheres, const glm::vec3& origin, const glm::vec3& direction, Utils::RayHit& hit)
+{
+    glm::vec3 dir = direction / glm::length(direction);
+    float best = FLT_MAX;
+    uint32_t bestObject = UINT32_MAX;
+    for(uint32_t i = 0; i < spheres.size(); i++)
+    {
+        glm::vec3 toCenter = glm::vec3(spheres[i]) - origin;
+        float along = glm::dot(toCenter, dir);
+        float distanceSquared = glm::dot(toCenter, toCenter) - along * along;
+        float radiusSquared = spheres[i].w * spheres[i].w;
+        if(distanceSquared > radiusSquared)
+            continue;
+
+        float halfChord = std::sqrt(radiusSquared - distanceSquared);
+        float distance = along - halfChord;
+        if(distance < 0.f)
+        {
+            if(along + halfChord < 0.f)
+                continue;
+            distance = 0.f;
+        }
+
+        if(distance < best)
+        {
+            best = distance;
+            bestObject = i;
+        }
+    }
+
+    hit.object = bestObject;
+    hit.distance = best;
+    return bestObject != UINT32_MAX;
+}
+
+int main(int argc, char** argv)
+{
+    //--objects n (default 10k, 100k and 1m) --iterations n --threads n --rays n
+    std::vector<uint32_t> objectCounts = {10000, 100000, 1000000};
+    uint32_t iterations = 20;
+    uint32_t threads = 0;
+    uint32_t rayCount = 1000;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if(arg == "--objects" && hasValue)
+            objectCounts = {static_cast<uint32_t>(std::max(1, std::stoi(argv[++i])))};
+        else if(arg == "--iterations" && hasValue)
+            iterations = static_cast<uint32_t>(std::max(1, std::stoi(argv[++i])));
+        else if(arg == "--threads" && hasValue)
+            threads = static_cast<uint32_t>(std::max(0, std::stoi(argv[++i])));
+        else if(arg == "--rays" && hasValue)
+            rayCount = static_cast<uint32_t>(std::max(1, std::stoi(argv[++i])));
+        else
+            std::cout << "unknown argument " << arg << "\n";
+    }
+
+    Utils::ThreadPool pool(threads);
+
+    //same camera setup as the renderer, roughly half of a cube around the origin ends up visible
+    glm::vec3 eye(2.f, 2.f, 2.f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 10.f);
+    Utils::Frustum frustum = Utils::Frustum::fromMatrix(proj * view);
+
+    std::cout << "instruction set: " << Utils::FrustumCuller::getInstructionSet() << " (" << Utils::FrustumCuller::getSimdWidth()
+              << " wide), " << pool.getThreadCount() << " threads, best of " << iterations << "\n";
+
+    bool mismatch = false;
+    for(uint32_t objectCount : objectCounts)
+    {
+        std::mt19937 random(objectCount);
+        std::uniform_real_distribution<float> position(-4.f, 4.f);
+        std::uniform_real_distribution<float> radius(0.01f, 0.2f);
+
+        std::vector<glm::vec4> spheres(objectCount);
+        for(auto& sphere : spheres)
+            sphere = glm::vec4(position(random), position(random), position(random), radius(random));
+
+        Utils::FrustumCuller culler;
+        culler.setSpheres(spheres);
+
+        std::vector<uint32_t> scalarVisible, simdVisible, threadedVisible;
+        double scalarTime = timeBest(iterations, [&]{ culler.cullScalar(frustum, scalarVisible); });
+        double simdTime = timeBest(iterations, [&]{ culler.cull(frustum, simdVisible); });
+        double threadedTime = timeBest(iterations, [&]{ culler.cull(frustum, threadedVisible, &pool); });
+
+        if(simdVisible != scalarVisible || threadedVisible != scalarVisible)
+        {
+            std::cout << "simd results differ from scalar for " << objectCount << " objects\n";
+            mismatch = true;
+        }
+
+        //the bvh returns its own order
+        Utils::Bvh bvh;
+        std::vector<uint32_t> bvhVisible;
+        double buildTime = timeBest(1, [&]{ bvh.build(spheres); });
+        double bvhTime = timeBest(iterations, [&]{ bvh.cull(frustum, bvhVisible); });
+        std::sort(bvhVisible.begin(), bvhVisible.end());
+        if(bvhVisible != scalarVisible)
+        {
+            std::cout << "bvh results differ from scalar for " << objectCount << " objects\n";
+            mismatch = true;
+        }
+
+        //every object drifts a little, as if the scene were animated, the refitted tree still has to cull exactly
+        std::vector<glm::vec4> moved = spheres;
+        for(auto& sphere : moved)
+            sphere += glm::vec4(0.05f, 0.f, 0.f, 0.f);
+        double refitTime = timeBest(iterations, [&]{ bvh.refit(moved); });
+        culler.setSpheres(moved);
+        culler.cullScalar(frustum, scalarVisible);
+        bvh.cull(frustum, bvhVisible);
+        std::sort(bvhVisible.begin(), bvhVisible.end());
+        if(bvhVisible != scalarVisible)
+        {
+            std::cout << "refitted bvh results differ from scalar for " << objectCount << " objects\n";
+            mismatch = true;
+        }
+
+        //one object at a time, only its leaf and the nodes above it are touched. every run moves the objects
+        //between their built and drifted positions so no refit finds its object already in place
+        uint32_t movedObjects = std::min(objectCount, 1000u);
+        uint32_t singleRefitRun = 0;
+        double singleRefitTime = timeBest(iterations, [&]
+        {
+            const std::vector<glm::vec4>& target = singleRefitRun++ % 2 == 0 ? spheres : moved;
+            for(uint32_t i = 0; i < movedObjects; i++)
+                bvh.refit(i, target[i]);
+        });
+
+        //the single refits left some objects at either position, put the whole tree back where it was built
+        bvh.refit(spheres);
+
+        //rays from the camera towards random points of the cube, like picking with the mouse
+        std::vector<glm::vec3> rayTargets(rayCount);
+        for(auto& target : rayTargets)
+            target = glm::vec3(position(random), position(random), position(random));
+
+        uint32_t rayHits = 0;
+        double rayTime = timeBest(iterations, [&]
+        {
+            rayHits = 0;
+            Utils::RayHit hit;
+            for(const auto& target : rayTargets)
+                rayHits += bvh.raycast(eye, target - eye, hit) ? 1 : 0;
+        });
+
+        //the tree holds the original spheres again, so brute force runs over them
+        for(const auto& target : rayTargets)
+        {
+            Utils::RayHit hit, expected;
+            bool hitAny = bvh.raycast(eye, target - eye, hit);
+            if(hitAny != raycastBruteForce(spheres, eye, target - eye, expected) || (hitAny && hit.object != expected.object))
+            {
+                std::cout << "bvh raycast differs from brute force for " << objectCount << " objects\n";
+                mismatch = true;
+                break;
+            }
+        }
+
+        std::cout << objectCount << " objects, " << simdVisible.size() << " visible\n"
+                  << "    scalar:   " << scalarTime << "ms, " << objectCount / scalarTime << " objects/ms\n"
+                  << "    simd:     " << simdTime << "ms, " << objectCount / simdTime << " objects/ms\n"
+                  << "    threaded: " << threadedTime << "ms, " << objectCount / threadedTime << " objects/ms\n"
+                  << "    bvh:      " << bvhTime << "ms, " << objectCount / bvhTime << " objects/ms ("
+                  << bvh.getNodeCount() << " nodes, depth " << bvh.getDepth() << ", built in " << buildTime << "ms)\n"
+                  << "    refit:    " << refitTime << "ms for all, " << singleRefitTime * 1000.0 / movedObjects << "us per object\n"
+                  << "    raycast:  " << rayTime * 1000.0 / rayCount << "us per ray, " << rayHits << "/" << rayCount << " hit\n";
+    }
+
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+//scene benchmark, built from every file in src except src/main.cpp plus this one
+//renders a procedurally generated scene for a fixed number of frames and prints the results as json
+
+#include "Application.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Renderer/Vulkan/MemoryAllocator.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+static void writePercentiles(std::ostream& stream, const char* name, const Utils::FrameStats::Percentiles& percentiles, bool last = false)
+{
+    stream << "    \"" << name << "\": {\"p50\": " << percentiles.p50 << ", \"p95\": " << percentiles.p95
+           << ", \"p99\": " << percentiles.p99 << ", \"avg\": " << percentiles.avg << ", \"max\": " << percentiles.max << "}"
+           << (last ? "\n" : ",\n");
+}
+
+static std::string getResultJson(const Application& app, const SceneDesc& desc, const RenderSettings& settings)
+{
+    const Scene& scene = app.getScene();
+    Utils::FrameStats::Summary summary = app.getFrameStats().summarize();
+
+    vk::DeviceSize reservedBytes = 0;
+    vk::DeviceSize usedBytes = 0;
+    for(const auto& heap : Renderer::Vulkan::MemoryAllocator::getHeapStats())
+    {
+        reservedBytes += heap.reservedBytes;
+        usedBytes += heap.usedBytes;
+    }
+
+    double fps = app.getRunTime() > 0.0 ? app.getFramesRendered() / app.getRunTime() : 0.0;
+
+    std::stringstream json;
+    json << "{\n";
+    json << "  \"scene\": {\"objects\": " << scene.objects.size() << ", \"instances\": " << scene.getInstanceCount() << ", \"triangles\": " << scene.getTriangleCount()
+         << ", \"textures\": " << scene.textureCount << ", \"materials\": " << scene.materialCount << ", \"seed\": " << desc.seed << "},\n";
+    json << "  \"settings\": \"" << settings.toString() << "\",\n";
+    json << "  \"frames\": " << app.getFramesRendered() << ",\n";
+    json << "  \"seconds\": " << app.getRunTime() << ",\n";
+    json << "  \"fps\": " << fps << ",\n";
+    json << "  \"cpu_ms\": {\n";
+    writePercentiles(json, "frame", summary.frame);
+    writePercentiles(json, "acquire", summary.acquire);
+    writePercentiles(json, "fence_wait", summary.fenceWait);
+    writePercentiles(json, "record", summary.record);
+    writePercentiles(json, "submit", summary.submit, true);
+    json << "  },\n";
+    json << "  \"draw_calls_per_frame\": " << app.getDrawCallsPerFrame() << ",\n";
+    json << "  \"visible_objects\": " << app.getVisibleObjectCount() << ",\n";
+    json << "  \"recorded_draw_calls\": " << app.getRecordedDrawCalls() << ",\n";
+    json << "  \"memory\": {\"device_allocations\": " << Renderer::Vulkan::MemoryAllocator::getDeviceMemoryCount()
+         << ", \"reserved_bytes\": " << reservedBytes << ", \"used_bytes\": " << usedBytes << "}\n";
+    json << "}\n";
+    return json.str();
+}
+
+int main(int argc, char** argv)
+{
+    //scene options are handled here, everything else goes to RenderSettings
+    //--objects n --triangles n --instances n --textures n --materials n --seed n --json file --window
+    SceneDesc desc;
+    std::string jsonFile;
+    bool window = false;
+    bool stats = false;
+    std::vector<char*> renderArgs = {argv[0]};
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if(arg == "--objects" && hasValue)
+            desc.objectCount = static_cast<uint32_t>(std::max(1, RenderSettings::parseInt(arg, argv[++i], desc.objectCount)));
+        else if(arg == "--triangles" && hasValue)
+            desc.trianglesPerObject = static_cast<uint32_t>(std::max(1, RenderSettings::parseInt(arg, argv[++i], desc.trianglesPerObject)));
+        else if(arg == "--instances" && hasValue)
+            desc.instancesPerObject = static_cast<uint32_t>(std::max(1, RenderSettings::parseInt(arg, argv[++i], desc.instancesPerObject)));
+        else if(arg == "--textures" && hasValue)
+            desc.textureCount = static_cast<uint32_t>(std::max(1, RenderSettings::parseInt(arg, argv[++i], desc.textureCount)));
+        else if(arg == "--materials" && hasValue)
+            desc.materialCount = static_cast<uint32_t>(std::max(1, RenderSettings::parseInt(arg, argv[++i], desc.materialCount)));
+        else if(arg == "--seed" && hasValue)
+        {
+            //the whole uint32_t range is a valid seed, more than parseInt takes
+            try
+            {
+                desc.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            catch(const std::exception&)
+            {
+                std::cout << "invalid value for " << arg << ": " << argv[i] << "\n";
+            }
+        }
+        else if(arg == "--json" && hasValue)
+            jsonFile = argv[++i];
+        else if(arg == "--window")
+            window = true;
+        else
+        {
+            stats = stats || arg == "--stats";
+            renderArgs.push_back(argv[i]);
+        }
+    }
+
+    //headless with a fixed frame count unless asked otherwise, the per frame csv/json dump is opt in
+    RenderSettings settings = RenderSettings::fromArgs(static_cast<int>(renderArgs.size()), renderArgs.data());
+    settings.headless = !window;
+    if(settings.frameCount == 0)
+        settings.frameCount = 500;
+    if(!stats)
+        settings.statsFile.clear();
+
+    std::cout << settings.toString() << "\n" << desc.toString() << "\n";
+
+    Application app(settings, Scene::generate(desc));
+    app.update();
+
+    std::string json = getResultJson(app, desc, settings);
+    if(jsonFile.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream file(jsonFile, std::ios::trunc);
+        file << json;
+        std::cout << "results written to " << jsonFile << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 v_fragColor;
+layout(location = 1) in vec2 v_texCoords;
+layout(location = 3) flat in uint v_texture;
+
+layout(location = 0) out vec4 outColor;
+
+//every scene texture, the instance picks one by index
+layout(binding = 1) uniform sampler2D textures[];
+
+//per material, selected with a dynamic offset. set 1 because set 0 can be update after bind, which dynamic buffers can not be
+layout(set = 1, binding = 0) uniform MaterialUniforms
+{
+ vec4 color;
+} material;
+
+void main()
+{
+    outColor = texture(textures[nonuniformEXT(v_texture)], v_texCoords) * material.color;
+}
@@ -1,3 +1,5 @@
 C:/VulkanSDK/1.3.216.0/Bin/glslc.exe shader.vert -o vert.spv
 C:/VulkanSDK/1.3.216.0/Bin/glslc.exe shader.frag -o frag.spv
+C:/VulkanSDK/1.3.216.0/Bin/glslc.exe bindless.frag -o frag_bindless.spv
+C:/VulkanSDK/1.3.216.0/Bin/glslc.exe cull.comp -o cull.spv
 pause
\ No newline at end of file
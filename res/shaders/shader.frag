@@ -7,7 +7,13 @@ layout(location = 0) out vec4 outColor;
 
 layout(binding = 1) uniform sampler2D texSampler;
 
+//per material, selected with a dynamic offset. set 1 because set 0 can be update after bind, which dynamic buffers can not be
+layout(set = 1, binding = 0) uniform MaterialUniforms
+{
+ vec4 color;
+} material;
+
 void main()
 {
-    outColor = texture(texSampler, v_texCoords);
+    outColor = texture(texSampler, v_texCoords) * material.color;
 }
\ No newline at end of file
@@ -6,18 +6,44 @@ layout(location = 2) in vec2 a_texCoords;
 
 layout(location = 0) out vec3 v_fragColor;
 layout(location = 1) out vec2 v_texCoords;
+layout(location = 2) flat out uint v_material;
+layout(location = 3) flat out uint v_texture;
 
 layout(binding = 0) uniform UniformBufferObject
 
 {
- mat4 model;
  mat4 view;
  mat4 proj;
 } ubo;
 
+//per draw, matches ObjectConstants in Vertex.h
+layout(push_constant) uniform ObjectConstants
+{
+ mat4 model;
+} object;
+
+//matches InstanceData in Vertex.h
+struct InstanceData
+{
+ mat4 model;
+ vec4 color;
+ uint material;
+ uint texture;
+};
+
+layout(std430, binding = 2) readonly buffer InstanceBuffer
+{
+ InstanceData instances[];
+};
+
 void main()
 {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(a_position, 1);
-    v_fragColor = a_color;
+    //gl_InstanceIndex already includes the draw's firstInstance
+    InstanceData instance = instances[gl_InstanceIndex];
+
+    gl_Position = ubo.proj * ubo.view * object.model * instance.model * vec4(a_position, 1);
+    v_fragColor = a_color * instance.color.rgb;
     v_texCoords = a_texCoords;
-}
\ No newline at end of file
+    v_material = instance.material;
+    v_texture = instance.texture;
+}
@@ -12,12 +12,20 @@
 #include <limits>
 #include <algorithm>
 #include <chrono>
+#include <fstream>
+#include <filesystem>
 
 #include "utils/DebugUtils.h"
 #include "utils/VulkanUtils.h"
 #include "utils/Utils.h"
+#include "utils/MappedFile.h"
 
 #include "Renderer/Vulkan/RenderCommand.h"
+#include "Renderer/Vulkan/MemoryAllocator.h"
+#include "Renderer/Vulkan/DynamicRendering.h"
+#include "Renderer/Vulkan/ParallelCommandRecorder.h"
+#include "Renderer/Vulkan/FrameScheduler.h"
+#include "Renderer/Vulkan/DescriptorIndexing.h"
 
 #include "Vertex.h"
 
@@ -29,33 +37,29 @@
 using VulkanUtils::SwapChainSupportDetails;
 using VulkanUtils::QueueFamilyIndices;
 
-const std::vector<Vertex> vertices =
-{
-    {{-0.5f, -0.5f, 0.f}, {1.0f, 0.0f, 1.0f}, {1.f, 0.f}},
-    {{ 0.5f, -0.5f, 0.f}, {1.0f, 0.0f, 1.0f}, {0.f, 0.f}},
-    {{ 0.5f,  0.5f, 0.f}, {0.0f, 0.0f, 1.0f}, {0.f, 1.f}},
-    {{-0.5f,  0.5f, 0.f}, {1.0f, 0.0f, 0.0f}, {1.f, 1.f}},
-
-    {{-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 1.0f}, {1.f, 0.f}},
-    {{ 0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 1.0f}, {0.f, 0.f}},
-    {{ 0.5f,  0.5f, -0.5f}, {0.0f, 0.0f, 1.0f}, {0.f, 1.f}},
-    {{-0.5f,  0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}, {1.f, 1.f}},
-};
-
-const std::vector<uint32_t> indices =
-{
-    0, 1, 2,
-    2, 3, 0,
-
-    4, 5, 6,
-    6, 7, 4,
-};
-
-Application::Application()
-    :m_depthImage(m_device, m_physicalDevice)
+Application::Application(const RenderSettings& settings, const Scene& scene)
+    :m_settings(settings)
+    , m_maxFramesInFlight(settings.framesInFlight)
+    , m_headless(settings.headless)
+    , m_pipelineDiskCache(m_device, m_physicalDevice)
+    , m_pipelineCache(m_device, m_pipelineDiskCache)
+    , m_commandRecorder(m_device)
+    , m_frameScheduler(m_device)
+    , m_framePacer(m_device)
+    , m_presentFences(m_device)
+    , m_gpuProfiler(m_device, m_physicalDevice)
+    , m_gpuCuller(m_device, m_physicalDevice)
+    , m_drawListBuffer(m_device, m_physicalDevice)
     , m_vertexBuffer(m_device, m_physicalDevice)
     , m_indexBuffer(m_device, m_physicalDevice)
+    , m_instanceBuffer(m_device, m_physicalDevice)
+    , m_materialBuffer(m_device, m_physicalDevice)
+    , m_uniformRing(m_device, m_physicalDevice)
+    , m_uploadManager(m_device, m_physicalDevice)
+    , m_stagingPool(m_device, m_physicalDevice)
+    , m_scene(scene)
     , m_texture(m_device, m_physicalDevice)
+    , m_depthImage(m_device, m_physicalDevice)
 {
     initGlfw();
     initVulkan();
@@ -68,17 +72,78 @@ Application::~Application()
 
 void Application::update()
 {
-    double start = 0;
-    double end = 0;
-    while(!glfwWindowShouldClose(m_window))
+    //steady clock instead of glfwGetTime, glfw is not initialised when headless
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::duration duration){ return std::chrono::duration<double>(duration).count(); };
+
+    uint32_t frameCount = m_settings.frameCount;
+    if(m_headless && frameCount == 0)
+        frameCount = m_defaultHeadlessFrames;
+
+    auto firstFrame = Clock::now();
+    auto start = firstFrame;
+    auto end = start;
+    auto lastStats = start;
+    uint32_t frame = 0;
+    while(frameCount ? frame < frameCount : !glfwWindowShouldClose(m_window))
     {
-        glfwPollEvents();
+        if(!m_headless)
+            glfwPollEvents();
+
+        //minimised: nothing to render into, sleep until something happens instead of spinning
+        if(!m_headless && isMinimized())
+        {
+            glfwWaitEvents();
+            start = Clock::now();
+            continue;
+        }
+
         drawFrame();
-        end = glfwGetTime();
-        //std::cout << (end - start) * 1000.f << "ms\n";
+        end = Clock::now();
+        m_frameTimings.frame = seconds(end - start) * 1000.0;
+        m_frameStats.record(m_frameTimings);
         start = end;
+        frame++;
+
+        if(!m_headless && glfwWindowShouldClose(m_window))
+            break;
+
+        if(Utils::FrameStats::consumeDumpRequest())
+            dumpFrameStats();
+
+        if(seconds(end - lastStats) >= m_gpuStatsInterval)
+        {
+            m_gpuProfiler.printStats();
+            lastStats = end;
+        }
     }
     m_device.waitIdle();
+
+    double totalTime = seconds(Clock::now() - firstFrame);
+    std::cout << frame << " frames in " << totalTime << "s (" << (totalTime > 0.0 ? frame / totalTime : 0.0) << " fps)\n";
+    m_framesRendered = frame;
+    m_runTime = totalTime;
+
+    if(m_headless && !m_settings.outputImage.empty() && frame > 0)
+        saveOffscreenImage(m_settings.outputImage);
+
+    dumpFrameStats();
+}
+
+void Application::dumpFrameStats()
+{
+    if(m_settings.statsFile.empty())
+        return;
+
+    if(!m_frameStats.writeCsv(m_settings.statsFile + ".csv") || !m_frameStats.writeJson(m_settings.statsFile + ".json"))
+    {
+        std::cout << "failed to write frame stats to " << m_settings.statsFile << ".csv/.json\n";
+        return;
+    }
+
+    Utils::FrameStats::Summary summary = m_frameStats.summarize();
+    std::cout << "frame stats (" << summary.frameCount << " frames): p50 " << summary.frame.p50 << "ms, p95 " << summary.frame.p95
+              << "ms, p99 " << summary.frame.p99 << "ms, written to " << m_settings.statsFile << ".csv/.json\n";
 }
 
 void Application::framebufferResizeCallback(GLFWwindow* window, int width, int height)
@@ -87,17 +152,58 @@ void Application::framebufferResizeCallback(GLFWwindow* window, int width, int h
     app->m_framebufferResized = true;
 }
 
-void Application::drawFrame()
+void Application::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
-    //wait for previous frame to finish
-    m_device.waitForFences(1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+    if(button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS)
+        return;
 
-    //get image from swap chain
-    
-    auto nextImgKHR = m_device.acquireNextImageKHR(m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame]);
+    //picked at the start of the next frame, with the camera that frame uses
+    auto app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    glfwGetCursorPos(window, &app->m_pickX, &app->m_pickY);
+    app->m_pickRequested = true;
+}
+
+void Application::drawFrame()
+{
+    //present wait and frame limiter, both before any cpu work so input is sampled as late as possible
+    //headless has no present wait, the frame limiter still applies
+    m_framePacer.waitForNextFrame(m_swapChain);
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point since){ return std::chrono::duration<double, std::milli>(Clock::now() - since).count(); };
+    m_frameTimings = Utils::FrameTimings();
+
+    //wait for the gpu to finish what this frame slot submitted last time
+    auto fenceStart = Clock::now();
+    m_frameScheduler.beginFrame(m_currentFrame);
+    m_frameTimings.fenceWait = elapsedMs(fenceStart);
+    m_gpuProfiler.collect(m_currentFrame);
+    m_presentFences.update();
+
+    //get image from swap chain, headless just takes the next offscreen image.
+    //the frame slot's wait above covers it, there are at least as many images as frames in flight
+    auto acquireStart = Clock::now();
+    vk::ResultValue<uint32_t> nextImgKHR(vk::Result::eSuccess, m_offscreenIndex);
+    if(m_headless)
+        m_offscreenIndex = (m_offscreenIndex + 1) % static_cast<uint32_t>(m_offscreenImages.size());
+    else
+    {
+        //vulkan.hpp throws on out of date instead of returning it
+        try
+        {
+            nextImgKHR = m_device.acquireNextImageKHR(m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame]);
+        }
+        catch(const vk::OutOfDateKHRError&)
+        {
+            nextImgKHR.result = vk::Result::eErrorOutOfDateKHR;
+        }
+    }
     uint32_t imageIndex = nextImgKHR.value;
+    m_frameTimings.acquire = elapsedMs(acquireStart);
 
-    if(m_framebufferResized || nextImgKHR.result == vk::Result::eErrorOutOfDateKHR)
+    //only recreate here if no image was acquired, otherwise the acquire semaphore would be left signalled.
+    //a resize with a usable image is picked up after present
+    if(nextImgKHR.result == vk::Result::eErrorOutOfDateKHR)
     {
         m_framebufferResized = false;
         recreateSwapChain();
@@ -108,35 +214,76 @@ void Application::drawFrame()
         throw std::runtime_error("failed to aquire swap chain image!");
     }
 
-    //reset fence if work is being submitted to avoid deadlock
-    m_device.resetFences(1, &m_inFlightFences[m_currentFrame]);
+    //reclaim finished uploads, anything still in flight is acquired by this frame
+    m_uploadManager.beginFrame();
+
+    //record command buffer, the camera is needed first to know which objects to record
+    auto recordStart = Clock::now();
+    updateCamera();
+    cullObjects();
+    pickObject();
+    std::vector<vk::CommandBuffer> submitCommandBuffers;
+    if(m_cachedRecording)
+    {
+        //upload acquires change every frame, they go into a small command buffer in front of the cached one
+        if(m_uploadManager.hasPendingAcquires())
+        {
+            vk::CommandBufferBeginInfo beginInfo;
+            beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+
+            m_commandBuffers[m_currentFrame].reset();
+            m_commandBuffers[m_currentFrame].begin(beginInfo);
+            m_uploadManager.recordAcquireBarriers(m_commandBuffers[m_currentFrame]);
+            m_commandBuffers[m_currentFrame].end();
+            submitCommandBuffers.push_back(m_commandBuffers[m_currentFrame]);
+        }
 
-    //record command buffer
-    m_commandBuffers[m_currentFrame].reset();
-    recordCommandBuffer(m_commandBuffers[m_currentFrame], imageIndex);
+        submitCommandBuffers.push_back(getCachedCommandBuffer(imageIndex));
+    }
+    else
+    {
+        m_commandBuffers[m_currentFrame].reset();
+        m_commandRecorder.beginSlot(m_currentFrame);
+        recordCommandBuffer(m_commandBuffers[m_currentFrame], imageIndex);
+        submitCommandBuffers.push_back(m_commandBuffers[m_currentFrame]);
+    }
 
+    //per frame data lives in buffers, so cached command buffers pick it up without re-recording
     updateUniformBuffer(m_currentFrame);
+    m_frameTimings.record = elapsedMs(recordStart);
 
     //submit command buffer
-    vk::SubmitInfo submitInfo;
-
-    vk::Semaphore waitSemaphores[]  = {m_imageAvailableSemaphores[m_currentFrame]};
-    vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
-    submitInfo.setWaitSemaphoreCount(1);
-    submitInfo.setPWaitSemaphores(waitSemaphores);
-    submitInfo.setPWaitDstStageMask(waitStages);
-
-    submitInfo.setCommandBufferCount(1);
-    submitInfo.setPCommandBuffers(&m_commandBuffers[m_currentFrame]);
+    auto submitStart = Clock::now();
+    std::vector<vk::Semaphore> waitSemaphores;
+    std::vector<vk::PipelineStageFlags> waitStages;
+    if(!m_headless)
+    {
+        waitSemaphores.push_back(m_imageAvailableSemaphores[m_currentFrame]);
+        waitStages.push_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+    }
+    m_uploadManager.getAcquireWaits(waitSemaphores, waitStages);
 
+    //nothing waits on the binary semaphore without a present
     vk::Semaphore signalSemaphores[] = {m_renderFinishedSemaphores[m_currentFrame]};
-    submitInfo.setSignalSemaphoreCount(1);
-    submitInfo.setPSignalSemaphores(signalSemaphores);
+    std::vector<vk::Semaphore> submitSignals;
+    if(!m_headless)
+        submitSignals.push_back(signalSemaphores[0]);
+    m_frameScheduler.submit(m_graphicsQueue, submitCommandBuffers, waitSemaphores, waitStages, submitSignals);
+    m_gpuProfiler.markSubmitted(m_currentFrame);
 
-    m_graphicsQueue.submit(submitInfo, m_inFlightFences[m_currentFrame]);
+    if(m_headless)
+    {
+        m_frameTimings.submit = elapsedMs(submitStart);
+        m_currentFrame = (m_currentFrame + 1) % m_maxFramesInFlight;
+        return;
+    }
 
     vk::SwapchainKHR swapChains[] = {m_swapChain};
     vk::PresentInfoKHR presentInfo;
+    const void* presentNext = m_framePacer.getPresentId();
+    if(m_presentFences.isEnabled())
+        presentNext = m_presentFences.getPresentFence(m_swapChain, presentNext);
+    presentInfo.setPNext(presentNext);
     presentInfo.setWaitSemaphoreCount(1);
     presentInfo.setPWaitSemaphores(signalSemaphores);
 
@@ -145,7 +292,17 @@ void Application::drawFrame()
     presentInfo.setPImageIndices(&imageIndex);
     presentInfo.setPResults(nullptr);
 
-    vk::Result presentKHRResult = m_presentQueue.presentKHR(presentInfo);
+    vk::Result presentKHRResult = vk::Result::eErrorOutOfDateKHR;
+    try
+    {
+        presentKHRResult = m_presentQueue.presentKHR(presentInfo);
+    }
+    catch(const vk::OutOfDateKHRError&)
+    {
+    }
+    m_frameTimings.submit = elapsedMs(submitStart);
+    if(presentKHRResult == vk::Result::eSuccess || presentKHRResult == vk::Result::eSuboptimalKHR)
+        m_presentFences.markPresented();
 
     if(presentKHRResult == vk::Result::eErrorOutOfDateKHR || presentKHRResult == vk::Result::eSuboptimalKHR || m_framebufferResized)
     {
@@ -161,40 +318,108 @@ void Application::drawFrame()
     m_currentFrame = (m_currentFrame + 1) % m_maxFramesInFlight;
 }
 
-void Application::updateUniformBuffer(uint32_t currentImage)
+void Application::updateCamera()
 {
     static auto startTime = std::chrono::high_resolution_clock::now();
     auto currentTime = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
-    UniformBufferObject ubo;
-    ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.proj = glm::perspective(glm::radians(45.0f), m_swapChainExtent.width / (float)m_swapChainExtent.height, 0.1f, 10.0f);
-    ubo.proj[1][1] *= -1; //flip image because glm was designed for opengl
+    //the spin used to be the ubo's model matrix, it is per frame so it lives in the view now
+    glm::mat4 spin = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    m_view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)) * spin;
+    m_proj = glm::perspective(glm::radians(45.0f), m_swapChainExtent.width / (float)m_swapChainExtent.height, 0.1f, 10.0f);
+    m_proj[1][1] *= -1; //flip image because glm was designed for opengl
+}
 
-    m_uniformBuffers[currentImage].allocateAndMap<UniformBufferObject>({ubo});
+void Application::updateUniformBuffer(uint32_t currentImage)
+{
+    //write straight into this frame's region of the persistently mapped ring, no map/unmap or copies
+    m_uniformRing.beginFrame(currentImage);
+    auto* ubo = static_cast<UniformBufferObject*>(m_uniformRing.allocate(sizeof(UniformBufferObject)).data);
+
+    ubo->view = m_view;
+    ubo->proj = m_proj;
 }
 
-void Application::recreateSwapChain()
+void Application::cullObjects()
+{
+    if(!m_cpuCulling)
+        return;
+
+    //the spin is part of the view, so the frustum moves every frame even though the objects do not
+    Utils::Frustum frustum = Utils::Frustum::fromMatrix(m_proj * m_view);
+    if(m_bvh.getObjectCount() > 0)
+        m_bvh.cull(frustum, m_visibleObjects);
+    else
+        m_frustumCuller.cull(frustum, m_visibleObjects, &m_threadPool);
+
+    //the recorded draws read their instance counts from this frame's draw list, so a new visible set never
+    //re-records the cached command buffers. beginFrame waited for the gpu to finish with the slot's list
+    size_t objectCount = m_scene.objects.size();
+    auto* commands = static_cast<vk::DrawIndexedIndirectCommand*>(m_drawListBuffer.getMappedData()) + m_currentFrame * objectCount;
+    std::vector<uint32_t>& drawn = m_drawListVisible[m_currentFrame];
+    for(uint32_t object : drawn)
+        commands[object].instanceCount = 0;
+    for(uint32_t object : m_visibleObjects)
+        commands[object].instanceCount = m_scene.objects[object].instanceCount;
+    drawn.assign(m_visibleObjects.begin(), m_visibleObjects.end());
+}
+
+void Application::pickObject()
 {
+    if(!m_pickRequested)
+        return;
+    m_pickRequested = false;
+
+    if(m_bvh.getObjectCount() == 0)
+        return;
+
+    //window coordinates to vulkan ndc (y down, depth 0..1), they differ from framebuffer pixels on high dpi displays
     int width = 0, height = 0;
-    glfwGetFramebufferSize(m_window, &width, &height);
+    glfwGetWindowSize(m_window, &width, &height);
+    if(width == 0 || height == 0)
+        return;
 
-    while(width == 0 || height == 0)
+    float x = static_cast<float>(m_pickX / width) * 2.f - 1.f;
+    float y = static_cast<float>(m_pickY / height) * 2.f - 1.f;
+
+    //the cursor's ray runs from the near to the far plane, in the world space the bvh was built in
+    glm::mat4 inverseViewProjection = glm::inverse(m_proj * m_view);
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, 0.f, 1.f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.f, 1.f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+
+    //bounding spheres only, close enough to tell which object is under the cursor
+    Utils::RayHit hit;
+    if(m_bvh.raycast(origin, direction, hit, glm::length(direction)))
+        std::cout << "picked object " << hit.object << " at distance " << hit.distance << "\n";
+    else
+        std::cout << "picked nothing\n";
+}
+
+void Application::recreateSwapChain()
+{
+    //minimised, update() waits for events and the next frame tries again
+    if(isMinimized())
     {
-        glfwGetFramebufferSize(m_window, &width, &height);
-        glfwWaitEvents();
+        m_framebufferResized = true;
+        return;
     }
 
-    m_device.waitIdle();
-
-    cleanupSwapChain();
+    //no device wait, frames in flight keep rendering into the old swapchain's resources
+    //which are destroyed once the gpu has finished everything submitted so far, the swapchain once its presents are done
+    retireSwapChain();
 
+    //passes the retired swapchain as oldSwapchain
     createSwapChain();
     createImageViews();
     createDepthResources();
     createFramebuffers();
+    m_framePacer.onSwapChainRecreated();
+
+    //everything recorded against the old swapchain is stale
+    createCachedCommandBuffers();
 }
 
 void Application::initVulkan()
@@ -211,10 +436,15 @@ void Application::initVulkan()
 
     createRenderPass();
     createDescriptorSetLayout();
+    createPipelineCache();
+    auto pipelineStart = std::chrono::high_resolution_clock::now();
     createGraphicsPipeline();
 
     createCommandPool();
 
+    //record every one time transition/copy below into a single submit
+    Renderer::Vulkan::InitBatch initBatch;
+
     createDepthResources();
 
     createFramebuffers();
@@ -223,44 +453,106 @@ void Application::initVulkan()
 
     createVertexBuffer();
     createIndexBuffer();
+    createInstanceBuffer();
+    createMaterialBuffer();
+
+    std::cout << "init batch saved " << initBatch.submit() << " queue submits\n";
 
     createUniformBuffers();
     createDescriptorPool();
     createDescriptorSets();
+    createGpuCulling();
+    createCpuCulling();
 
     createCommandBuffers();
+    createCachedCommandBuffers();
     createSyncObjects();
 
+    //the remaining permutations compiled in the background while the rest of init ran
+    m_pipelineCache.waitIdle();
+    double pipelineTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - pipelineStart).count();
+    createMaterialPipelines();
+    std::cout << m_pipelineCache.getPipelineCount() << " pipelines ready after " << pipelineTime << "ms ("
+              << m_pipelineCache.getCompileTime() << "ms of compilation on "
+              << (m_parallelPipelineCompilation ? m_threadPool.getThreadCount() : 1) << " threads)\n";
+
     DebugUtils::printExtensionsInfo();
+    Renderer::Vulkan::MemoryAllocator::printStats();
+    m_pipelineDiskCache.printStats();
 }
 
 void Application::initGlfw()
 {
+    if(m_headless)
+        return;
+
     glfwInit();
 
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    m_window = glfwCreateWindow(m_windowWidth, m_windowHeight, "Vulkan window", nullptr, nullptr);
+    m_window = glfwCreateWindow(m_settings.width, m_settings.height, "Vulkan window", nullptr, nullptr);
     glfwSetWindowUserPointer(m_window, this);
     glfwSetFramebufferSizeCallback(m_window, framebufferResizeCallback);
+    glfwSetMouseButtonCallback(m_window, mouseButtonCallback);
 }
 
 void Application::cleanup()
 {
+    m_frameScheduler.free();
+    m_presentFences.free();
+    m_gpuProfiler.printStats();
+    m_gpuProfiler.free();
+    m_gpuCuller.free();
+    m_pipelineCache.free();
+    m_pipelineDiskCache.save();
+    m_pipelineDiskCache.free();
+
+    if(!m_cachedCommandBuffers.empty())
+        m_device.freeCommandBuffers(m_commandPool, m_cachedCommandBuffers);
+    m_commandRecorder.free();
+    m_uploadManager.free();
+    m_stagingPool.free();
+    Renderer::Vulkan::MemoryAllocator::shutdown();
+    Utils::trimFileCache();
+
     if(m_enableValidationLayers) 
         DebugUtils::DestroyDebugUtilsMessengerEXT(m_instance, m_debugMessenger, nullptr);
 }
 
-void Application::cleanupSwapChain()
+void Application::retireSwapChain()
 {
-    m_depthImage.free();
+    //m_swapChain itself stays set so createSwapChain can hand it over as oldSwapchain
+    Renderer::Vulkan::Image depthImage = m_depthImage;
+    std::vector<vk::Framebuffer> framebuffers = std::move(m_swapChainFramebuffers);
+    std::vector<vk::ImageView> imageViews = std::move(m_swapChainImageViews);
+    std::vector<Renderer::Vulkan::Image> offscreenImages = std::move(m_offscreenImages);
+    vk::SwapchainKHR swapChain = m_swapChain;
+
+    m_swapChainFramebuffers.clear();
+    m_swapChainImageViews.clear();
+    m_offscreenImages.clear();
+
+    m_frameScheduler.deferUntil(m_frameScheduler.getLastSubmittedValue(),
+        [this, depthImage, framebuffers, imageViews, offscreenImages, swapChain]() mutable
+        {
+            depthImage.free();
+
+            for(auto framebuffer : framebuffers)
+                m_device.destroyFramebuffer(framebuffer);
 
-    for(auto framebuffer : m_swapChainFramebuffers)
-        m_device.destroyFramebuffer(framebuffer);
+            //offscreen images own their views
+            if(!offscreenImages.empty())
+            {
+                for(auto& image : offscreenImages)
+                    image.free();
+                return;
+            }
 
-    for(auto imageView : m_swapChainImageViews)
-        m_device.destroyImageView(imageView);
+            for(auto imageView : imageViews)
+                m_device.destroyImageView(imageView);
 
-    m_device.destroySwapchainKHR(m_swapChain);
+            //the last submit finishing does not mean the presentation engine is done with the images
+            m_presentFences.destroyAfterPresents(swapChain);
+        });
 }
 
 void Application::createInstance()
@@ -271,7 +563,7 @@ void Application::createInstance()
     appInfo.setApplicationVersion(VK_MAKE_VERSION(1, 0, 0));
     appInfo.setPEngineName("no engine");
     appInfo.setEngineVersion(VK_MAKE_VERSION(1, 0, 0));
-    appInfo.setApiVersion(VK_API_VERSION_1_0);
+    appInfo.setApiVersion(VK_API_VERSION_1_3); //highest version we can use, device features are still checked one by one
 
     //check validation layers support
     if(m_enableValidationLayers && !DebugUtils::checkValidationLayerSupport(m_validationLayers))
@@ -282,7 +574,8 @@ void Application::createInstance()
     createInfo.setPApplicationInfo(&appInfo);
 
     //add extensions
-    auto extensions = VulkanUtils::getRequiredExtensions(m_enableValidationLayers);
+    auto extensions = VulkanUtils::getRequiredExtensions(m_enableValidationLayers, !m_headless);
+    m_surfaceMaintenance = !m_headless && Renderer::Vulkan::PresentFences::addInstanceExtensions(extensions);
     createInfo.setEnabledExtensionCount(static_cast<uint32_t>(extensions.size()));
     createInfo.setPEnabledExtensionNames(extensions);
 
@@ -322,9 +615,13 @@ void Application::pickPhysicalDevice()
     if(devices.empty())
         throw std::runtime_error("failed to find GPUs with Vulkan support!");
 
+    //headless needs no device extensions at all, the surface is null so present support is not checked either
+    std::vector<const char*> requiredExtensions = m_headless ? std::vector<const char*>() : m_deviceExtensions;
+
     for(const auto& device : devices)
     {
-        if(VulkanUtils::isDeviceSuitable(device, m_surface, m_deviceExtensions))
+        //frame pacing is built on timeline semaphores (vulkan 1.2)
+        if(VulkanUtils::isDeviceSuitable(device, m_surface, requiredExtensions) && Renderer::Vulkan::FrameScheduler::isSupported(device))
         {
             m_physicalDevice = device;
             return;
@@ -340,6 +637,8 @@ void Application::createLogicalDevice()
     QueueFamilyIndices indices = VulkanUtils::findQueueFamilies(m_physicalDevice, m_surface);
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    if(indices.transferFamily.has_value())
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
 
     //create q infos
     for(uint32_t queueFamily : uniqueQueueFamilies)
@@ -361,8 +660,91 @@ void Application::createLogicalDevice()
     createInfo.setPQueueCreateInfos(queueCreateInfos.data());
     createInfo.setPEnabledFeatures(&deviceFeatures);
 
-    createInfo.setEnabledExtensionCount(static_cast<uint32_t>(m_deviceExtensions.size()));
-    createInfo.setPEnabledExtensionNames(m_deviceExtensions);
+    //optional extensions
+    std::vector<const char*> enabledExtensions = m_headless ? std::vector<const char*>() : m_deviceExtensions;
+    m_pipelineCreationFeedback = VulkanUtils::checkDeviceExtensionSupport(m_physicalDevice, {VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME});
+    if(m_pipelineCreationFeedback)
+        enabledExtensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+    //feature structs are pushed onto the front of the pNext chain
+    void* featureChain = nullptr;
+
+    //timeline semaphores are required (checked in pickPhysicalDevice), gpu culling also needs drawIndirectCount (and drawIndirectFirstInstance)
+    vk::PhysicalDeviceVulkan12Features vulkan12Features;
+    vulkan12Features.setTimelineSemaphore(true);
+    m_drawIndirectCount = m_settings.gpuCulling && Renderer::Vulkan::GpuCuller::isSupported(m_physicalDevice);
+    if(m_settings.gpuCulling && !m_drawIndirectCount)
+        std::cout << "drawIndirectCount or drawIndirectFirstInstance is not supported, gpu culling is off\n";
+    vulkan12Features.setDrawIndirectCount(m_drawIndirectCount);
+    //indirect draws keep each object's firstInstance, with gpu culling and with the cpu culling draw list
+    m_drawIndirectFirstInstance = (m_drawIndirectCount || m_settings.cpuCulling) && m_physicalDevice.getFeatures().drawIndirectFirstInstance;
+    deviceFeatures.drawIndirectFirstInstance = m_drawIndirectFirstInstance;
+
+    //lets upload batches on a transfer only queue reset their timestamp queries
+    m_hostQueryReset = Renderer::Vulkan::GpuProfiler::supportsHostQueryReset(m_physicalDevice);
+    vulkan12Features.setHostQueryReset(m_hostQueryReset);
+
+    //bindless textures, also needs the fragment shader that indexes the array
+    m_bindless = m_settings.bindless && Renderer::Vulkan::DescriptorIndexing::isSupported(m_physicalDevice, m_scene.textureCount);
+    if(m_settings.bindless && !m_bindless)
+        std::cout << "descriptor indexing is not supported (or too few samplers), bindless textures are off\n";
+    if(m_bindless && !std::filesystem::exists(m_bindlessFragShader))
+    {
+        std::cout << m_bindlessFragShader << " is missing, bindless textures are off\n";
+        m_bindless = false;
+    }
+    if(m_bindless)
+    {
+        Renderer::Vulkan::DescriptorIndexing::enableFeatures(vulkan12Features);
+        //isSupported checked the limit fits every scene texture
+        m_bindlessTextureCount = std::min(std::max(m_maxBindlessTextures, m_scene.textureCount), Renderer::Vulkan::DescriptorIndexing::getMaxTextureCount(m_physicalDevice));
+    }
+    std::cout << "textures: " << (m_bindless ? "bindless" : "descriptor set per texture") << "\n";
+    featureChain = &vulkan12Features;
+
+    //dynamic rendering replaces the render pass and framebuffers, the render pass path is the fallback
+    vk::PhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures;
+    m_dynamicRendering = m_preferDynamicRendering && Renderer::Vulkan::DynamicRendering::isSupported(m_physicalDevice);
+    if(m_dynamicRendering)
+    {
+        Renderer::Vulkan::DynamicRendering::addRequiredExtensions(m_physicalDevice, enabledExtensions);
+        dynamicRenderingFeatures.setDynamicRendering(true);
+        dynamicRenderingFeatures.setPNext(featureChain);
+        featureChain = &dynamicRenderingFeatures;
+    }
+
+    //present wait pacing, only if asked for
+    vk::PhysicalDevicePresentIdFeaturesKHR presentIdFeatures;
+    vk::PhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures;
+    bool presentWait = m_settings.presentWait && !m_headless && Renderer::Vulkan::FramePacer::isPresentWaitSupported(m_physicalDevice);
+    if(m_settings.presentWait && !presentWait)
+        std::cout << "VK_KHR_present_wait is not supported, present wait pacing is off\n";
+
+    if(presentWait)
+    {
+        Renderer::Vulkan::FramePacer::addPresentWaitExtensions(enabledExtensions);
+        presentIdFeatures.setPresentId(true);
+        presentIdFeatures.setPNext(featureChain);
+        presentWaitFeatures.setPresentWait(true);
+        presentWaitFeatures.setPNext(&presentIdFeatures);
+        featureChain = &presentWaitFeatures;
+    }
+
+    //present fences, so a retired swapchain is destroyed once its presents are done instead of idling the present queue
+    vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchainMaintenanceFeatures;
+    bool presentFences = m_surfaceMaintenance && Renderer::Vulkan::PresentFences::isSupported(m_physicalDevice);
+    if(presentFences)
+    {
+        Renderer::Vulkan::PresentFences::addDeviceExtensions(enabledExtensions);
+        swapchainMaintenanceFeatures.setSwapchainMaintenance1(true);
+        swapchainMaintenanceFeatures.setPNext(featureChain);
+        featureChain = &swapchainMaintenanceFeatures;
+    }
+
+    createInfo.setPNext(featureChain);
+
+    createInfo.setEnabledExtensionCount(static_cast<uint32_t>(enabledExtensions.size()));
+    createInfo.setPEnabledExtensionNames(enabledExtensions);
 
     //add validation layer info (backward compatability, not needed for new versions of vulkan)
     if(m_enableValidationLayers)
@@ -377,13 +759,26 @@ void Application::createLogicalDevice()
 
      m_device = m_physicalDevice.createDevice(createInfo);
 
+    if(m_dynamicRendering)
+        Renderer::Vulkan::DynamicRendering::init(m_device);
+    std::cout << "rendering path: " << (m_dynamicRendering ? "dynamic rendering" : "render pass") << "\n";
+
+    m_framePacer.init(presentWait, m_settings.presentWaitLatency, m_settings.maxFps);
+    m_presentFences.init(presentFences, m_maxFramesInFlight);
+
     //set up graphics queue, the 0 is the queue count/index
     m_graphicsQueue = m_device.getQueue(indices.graphicsFamily.value(), 0);
     m_presentQueue = m_device.getQueue(indices.presentFamily.value(), 0);
+    m_transferQueue = m_device.getQueue(indices.transferFamily.value_or(indices.graphicsFamily.value()), 0);
+
+    Renderer::Vulkan::MemoryAllocator::init(m_device, m_physicalDevice);
 }
 
 void Application::createSurface()
 {
+    if(m_headless)
+        return;
+
     VkSurfaceKHR surface;
     if(glfwCreateWindowSurface(m_instance, m_window, nullptr, &surface) != VK_SUCCESS)
         throw std::runtime_error("failed to create window surface!");
@@ -392,6 +787,12 @@ void Application::createSurface()
 
 void Application::createSwapChain()
 {
+    if(m_headless)
+    {
+        createOffscreenTargets();
+        return;
+    }
+
     glm::ivec2 framebufferSize;
     glfwGetFramebufferSize(m_window, &framebufferSize.x, &framebufferSize.y);
 
@@ -399,13 +800,14 @@ void Application::createSwapChain()
     SwapChainSupportDetails swapChainSupport = VulkanUtils::querySwapChainSupport(m_physicalDevice, m_surface);
 
     vk::SurfaceFormatKHR surfaceFormat = VulkanUtils::chooseSwapSurfaceFormat(swapChainSupport.formats);
-    vk::PresentModeKHR presentMode = VulkanUtils::chooseSwapPresentMode(swapChainSupport.presentModes);
+    vk::PresentModeKHR presentMode = VulkanUtils::chooseSwapPresentMode(swapChainSupport.presentModes, m_settings.presentMode);
     vk::Extent2D extent = VulkanUtils::chooseSwapExtent(swapChainSupport.capabilities, framebufferSize);
 
     //set img count
-    uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-    if(swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount)
-        imageCount = swapChainSupport.capabilities.maxImageCount;
+    uint32_t imageCount = VulkanUtils::chooseSwapImageCount(swapChainSupport.capabilities, m_settings.swapChainImages);
+
+    if(presentMode != m_settings.presentMode)
+        std::cout << vk::to_string(m_settings.presentMode) << " is not supported, using " << vk::to_string(presentMode) << "\n";
 
     //create swap chain info
     vk::SwapchainCreateInfoKHR createInfo{};
@@ -440,7 +842,8 @@ void Application::createSwapChain()
     createInfo.setCompositeAlpha(vk::CompositeAlphaFlagBitsKHR::eOpaque);
     createInfo.setPresentMode(presentMode);
     createInfo.setClipped(true);
-    createInfo.setOldSwapchain(VK_NULL_HANDLE);
+    //the old swapchain (if any) is retired, the driver can reuse its resources and it is destroyed deferred
+    createInfo.setOldSwapchain(m_swapChain);
 
     m_swapChain = m_device.createSwapchainKHR(createInfo);
 
@@ -450,8 +853,90 @@ void Application::createSwapChain()
     m_swapChainExtent = extent;
 }
 
+void Application::createOffscreenTargets()
+{
+    //fixed format instead of a surface format, rgba8 is always usable as attachment and copy source
+    m_swapChainImageFormat = vk::Format::eR8G8B8A8Unorm;
+    m_swapChainExtent = vk::Extent2D(m_settings.width, m_settings.height);
+
+    //one image per frame in flight so a frame never renders into an image the gpu is still using
+    uint32_t imageCount = std::max(m_settings.swapChainImages, m_maxFramesInFlight);
+
+    m_offscreenImages.clear();
+    m_offscreenImages.reserve(imageCount);
+    m_swapChainImages.clear();
+    for(uint32_t i = 0; i < imageCount; i++)
+    {
+        auto& image = m_offscreenImages.emplace_back(m_device, m_physicalDevice);
+        image.setSize(m_swapChainExtent.width, m_swapChainExtent.height);
+        image.create(m_swapChainImageFormat,
+                     vk::ImageTiling::eOptimal,
+                     vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                     vk::MemoryPropertyFlagBits::eDeviceLocal,
+                     vk::ImageAspectFlagBits::eColor);
+        m_swapChainImages.push_back(image.getHandle());
+    }
+    m_offscreenIndex = 0;
+}
+
+void Application::saveOffscreenImage(const std::string& filename)
+{
+    //the last submitted frame used the image before m_offscreenIndex
+    uint32_t imageCount = static_cast<uint32_t>(m_offscreenImages.size());
+    Renderer::Vulkan::Image& image = m_offscreenImages[(m_offscreenIndex + imageCount - 1) % imageCount];
+
+    Renderer::Vulkan::Buffer readback(m_device, m_physicalDevice);
+    readback.create(image.getWidth() * image.getHeight() * 4, vk::BufferUsageFlagBits::eTransferDst,
+                    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    vk::CommandBuffer commandBuffer = Renderer::Vulkan::RenderCommand::beginSingleTimeCommands();
+
+    //the frame left the image in transfer src layout, only the attachment writes have to be made visible
+    vk::ImageMemoryBarrier barrier;
+    barrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+    barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+    barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    barrier.setImage(image.getHandle());
+    barrier.setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
+    barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer,
+                                  {}, nullptr, nullptr, barrier);
+
+    image.recordCopyToBuffer(commandBuffer, readback.getHandle(), 0, vk::ImageAspectFlagBits::eColor);
+
+    Renderer::Vulkan::RenderCommand::endSingleTimeCommands(commandBuffer);
+
+    //binary ppm, rgb only
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        std::cout << "failed to write " << filename << "\n";
+        readback.free();
+        return;
+    }
+
+    file << "P6\n" << image.getWidth() << " " << image.getHeight() << "\n255\n";
+    const uint8_t* pixels = static_cast<const uint8_t*>(readback.getMappedData());
+    for(size_t i = 0; i < static_cast<size_t>(image.getWidth()) * image.getHeight(); i++)
+        file.write(reinterpret_cast<const char*>(pixels + i * 4), 3);
+
+    std::cout << "last frame written to " << filename << "\n";
+    readback.free();
+}
+
 void Application::createImageViews()
 {
+    //offscreen images come with their own views
+    if(m_headless)
+    {
+        m_swapChainImageViews.clear();
+        for(auto& image : m_offscreenImages)
+            m_swapChainImageViews.push_back(image.getImageView());
+        return;
+    }
+
     m_swapChainImageViews.resize(m_swapChainImages.size());
 
     //create all swap chain image views
@@ -463,6 +948,10 @@ void Application::createImageViews()
 
 void Application::createFramebuffers()
 {
+    //dynamic rendering attaches the image views directly
+    if(m_dynamicRendering)
+        return;
+
     //fill framebuffer vector with swapchain img info
     m_swapChainFramebuffers.resize(m_swapChainImageViews.size());
     for(size_t i = 0; i < m_swapChainImageViews.size(); i++)
@@ -487,6 +976,9 @@ void Application::createFramebuffers()
 
 void Application::createRenderPass()
 {
+    if(m_dynamicRendering)
+        return;
+
     vk::AttachmentDescription colorAttachment;
     colorAttachment.setFormat(m_swapChainImageFormat);
     colorAttachment.setSamples(vk::SampleCountFlagBits::e1);
@@ -495,7 +987,7 @@ void Application::createRenderPass()
     colorAttachment.setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
     colorAttachment.setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
     colorAttachment.setInitialLayout(vk::ImageLayout::eUndefined);
-    colorAttachment.setFinalLayout(vk::ImageLayout::ePresentSrcKHR);
+    colorAttachment.setFinalLayout(getTargetFinalLayout());
 
     vk::AttachmentDescription depthAttachment;
     depthAttachment.setFormat(VulkanUtils::findDepthFormat(m_physicalDevice));
@@ -550,176 +1042,155 @@ void Application::createDescriptorSetLayout()
     uboLayoutBinding.setStageFlags(vk::ShaderStageFlagBits::eVertex);
     uboLayoutBinding.setPImmutableSamplers(nullptr); //optional
 
+    //bindless: one big array of every texture, indexed per instance in bindless.frag
     vk::DescriptorSetLayoutBinding samplerLayoutBinding;
     samplerLayoutBinding.setBinding(1);
-    samplerLayoutBinding.setDescriptorCount(1);
+    samplerLayoutBinding.setDescriptorCount(m_bindless ? m_bindlessTextureCount : 1);
     samplerLayoutBinding.setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
     samplerLayoutBinding.setPImmutableSamplers(nullptr);
     samplerLayoutBinding.setStageFlags(vk::ShaderStageFlagBits::eFragment);
 
-    std::array<vk::DescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
+    vk::DescriptorSetLayoutBinding instanceLayoutBinding;
+    instanceLayoutBinding.setBinding(2);
+    instanceLayoutBinding.setDescriptorCount(1);
+    instanceLayoutBinding.setDescriptorType(vk::DescriptorType::eStorageBuffer);
+    instanceLayoutBinding.setPImmutableSamplers(nullptr);
+    instanceLayoutBinding.setStageFlags(vk::ShaderStageFlagBits::eVertex);
+
+    std::array<vk::DescriptorSetLayoutBinding, 3> bindings = {uboLayoutBinding, samplerLayoutBinding, instanceLayoutBinding};
     vk::DescriptorSetLayoutCreateInfo layoutInfo;
     layoutInfo.setBindingCount(static_cast<uint32_t>(bindings.size()));
     layoutInfo.setPBindings(bindings.data());
 
+    //textures can be written into the array while the set is bound, slots that are never used need no descriptor
+    std::array<vk::DescriptorBindingFlags, 3> bindingFlags = {vk::DescriptorBindingFlags(),
+        vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind, vk::DescriptorBindingFlags()};
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo;
+    bindingFlagsInfo.setBindingFlags(bindingFlags);
+    if(m_bindless)
+    {
+        layoutInfo.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool);
+        layoutInfo.setPNext(&bindingFlagsInfo);
+    }
+
     m_descriptorSetLayout = m_device.createDescriptorSetLayout(layoutInfo);
+
+    //material blocks, one buffer for all of them and the offset picks one when set 1 is bound
+    vk::DescriptorSetLayoutBinding materialLayoutBinding;
+    materialLayoutBinding.setBinding(0);
+    materialLayoutBinding.setDescriptorCount(1);
+    materialLayoutBinding.setDescriptorType(vk::DescriptorType::eUniformBufferDynamic);
+    materialLayoutBinding.setPImmutableSamplers(nullptr);
+    materialLayoutBinding.setStageFlags(vk::ShaderStageFlagBits::eFragment);
+
+    vk::DescriptorSetLayoutCreateInfo materialLayoutInfo;
+    materialLayoutInfo.setBindingCount(1);
+    materialLayoutInfo.setPBindings(&materialLayoutBinding);
+
+    m_materialSetLayout = m_device.createDescriptorSetLayout(materialLayoutInfo);
 }
 
-void Application::createGraphicsPipeline()
+void Application::createPipelineCache()
 {
-    //create shader modules
-    auto vertShaderCode = Utils::readFile("res/shaders/vert.spv");
-    auto fragShaderCode = Utils::readFile("res/shaders/frag.spv");
-    vk::ShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    vk::ShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-
-    //create shader info
-    vk::PipelineShaderStageCreateInfo vertShaderStageInfo;
-    vk::PipelineShaderStageCreateInfo fragShaderStageInfo;
+    m_pipelineDiskCache.load(m_pipelineCacheFile);
+    m_pipelineCache.init(m_pipelineCreationFeedback);
+}
 
-    //vertex shader info
-    vertShaderStageInfo.setStage(vk::ShaderStageFlagBits::eVertex);
-    vertShaderStageInfo.setModule(vertShaderModule);
-    vertShaderStageInfo.setPName("main");
-    vertShaderStageInfo.setPSpecializationInfo(nullptr);
+void Application::createGraphicsPipeline()
+{
+    if(!m_pipelineLayout)
+    {
+        //set 0 frame and texture data, set 1 the material
+        std::array<vk::DescriptorSetLayout, 2> setLayouts = {m_descriptorSetLayout, m_materialSetLayout};
+        vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+        pipelineLayoutInfo.setSetLayoutCount(static_cast<uint32_t>(setLayouts.size()));
+        pipelineLayoutInfo.setPSetLayouts(setLayouts.data());
+        //per object model matrix
+        vk::PushConstantRange pushConstantRange;
+        pushConstantRange.setStageFlags(vk::ShaderStageFlagBits::eVertex);
+        pushConstantRange.setOffset(0);
+        pushConstantRange.setSize(sizeof(ObjectConstants));
+
+        pipelineLayoutInfo.setPushConstantRangeCount(1);
+        pipelineLayoutInfo.setPPushConstantRanges(&pushConstantRange);
+
+        m_pipelineLayout = m_device.createPipelineLayout(pipelineLayoutInfo);
+    }
 
-    //fragment shader info
-    fragShaderStageInfo.setStage(vk::ShaderStageFlagBits::eFragment);
-    fragShaderStageInfo.setModule(fragShaderModule);
-    fragShaderStageInfo.setPName("main");
-    fragShaderStageInfo.setPSpecializationInfo(nullptr);
+    //every permutation we know about up front, the first one is the pipeline used for drawing
+    std::vector<Renderer::Vulkan::PipelineState> permutations = getPipelinePermutations();
+    m_materialStates = permutations;
 
-    std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo, fragShaderStageInfo};
+    //only the states the scene's materials map to are compiled now, any other state is compiled by the
+    //pipeline cache the first time it is requested
+    size_t usedCount = std::clamp<size_t>(m_scene.materialCount, 1, permutations.size());
+    std::vector<Renderer::Vulkan::PipelineState> startupStates(permutations.begin(), permutations.begin() + usedCount);
 
-    //dynamic state
-    std::vector<vk::DynamicState> dynamicStates =
+    if(m_parallelPipelineCompilation)
     {
-        vk::DynamicState::eViewport,
-        vk::DynamicState::eScissor,
-    };
+        //a single material scene still compiles one extra variant so the worker path is exercised
+        if(startupStates.size() == 1 && permutations.size() > 1)
+            startupStates.push_back(permutations[1]);
+        m_pipelineCache.compileAsync(startupStates, m_threadPool);
+    }
+    else
+    {
+        for(const auto& state : startupStates)
+            m_pipelineCache.get(state);
+    }
+
+    //identical states come back as the same vk::Pipeline, blocks until it is compiled
+    m_graphicsPipeline = m_pipelineCache.get(permutations[0]);
+}
 
-    vk::PipelineDynamicStateCreateInfo dynamicState;
-    dynamicState.setDynamicStateCount(static_cast<uint32_t>(dynamicStates.size()));
-    dynamicState.setPDynamicStates(dynamicStates.data());
+void Application::createMaterialPipelines()
+{
+    //after the async compile finished, so none of these block
+    m_materialPipelines.clear();
+    for(uint32_t material = 0; material < m_scene.materialCount; material++)
+        m_materialPipelines.push_back(m_pipelineCache.get(m_materialStates[material % m_materialStates.size()]));
+}
 
-    //vertex input info
-    auto bindingDescription = Vertex::getBindingDescription();
+std::vector<Renderer::Vulkan::PipelineState> Application::getPipelinePermutations()
+{
     auto attributeDescriptions = Vertex::getAttributeDescriptions();
 
-    vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
-    vertexInputInfo.setVertexBindingDescriptionCount(1);
-    vertexInputInfo.setPVertexBindingDescriptions(&bindingDescription);
-    vertexInputInfo.setVertexAttributeDescriptionCount(static_cast<uint32_t>(attributeDescriptions.size()));
-    vertexInputInfo.setPVertexAttributeDescriptions(attributeDescriptions.data());
+    Renderer::Vulkan::PipelineBuilder builder;
+    builder.setShaders("res/shaders/vert.spv", m_bindless ? m_bindlessFragShader : "res/shaders/frag.spv")
+           .setVertexLayout({Vertex::getBindingDescription()}, {attributeDescriptions.begin(), attributeDescriptions.end()})
+           .setTopology(vk::PrimitiveTopology::eTriangleList)
+           .setRasterizer(vk::PolygonMode::eFill, vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise)
+           .setAlphaBlending(false) //opaque like before the builder, blending is one of the variants below
+           .setDepth(true, true, vk::CompareOp::eLess)
+           .setLayout(m_pipelineLayout);
+
+    if(m_dynamicRendering)
+        builder.setRenderingFormats(m_swapChainImageFormat, VulkanUtils::findDepthFormat(m_physicalDevice));
+    else
+        builder.setRenderPass(m_renderPass, 0);
 
-    //input assembly
-    vk::PipelineInputAssemblyStateCreateInfo inputAssembly;
-    inputAssembly.setTopology(vk::PrimitiveTopology::eTriangleList);
-    inputAssembly.setPrimitiveRestartEnable(false);
+    std::vector<Renderer::Vulkan::PipelineState> permutations;
+    permutations.push_back(builder.getState());
 
-    //viewport and scissor
-    vk::Viewport viewport{};
-    viewport.setX(0.f);
-    viewport.setY(0.f);
-    viewport.setWidth(static_cast<float>(m_swapChainExtent.width));
-    viewport.setHeight(static_cast<float>(m_swapChainExtent.height));
-    viewport.setMinDepth(0.f);
-    viewport.setMaxDepth(1.f);
-
-    vk::Rect2D scissor;
-    scissor.setOffset({0, 0});
-    scissor.setExtent(m_swapChainExtent);
+    //material variants: blending x culling x depth writes
+    for(bool blend : {true, false})
+    {
+        for(vk::CullModeFlags cullMode : {vk::CullModeFlags(vk::CullModeFlagBits::eBack), vk::CullModeFlags(vk::CullModeFlagBits::eNone)})
+        {
+            for(bool depthWrite : {true, false})
+            {
+                Renderer::Vulkan::PipelineBuilder variant = builder;
+                variant.setAlphaBlending(blend)
+                       .setRasterizer(vk::PolygonMode::eFill, cullMode, vk::FrontFace::eCounterClockwise)
+                       .setDepth(true, depthWrite, vk::CompareOp::eLess);
+
+                if(!(variant.getState() == permutations[0]))
+                    permutations.push_back(variant.getState());
+            }
+        }
+    }
 
-    vk::PipelineViewportStateCreateInfo viewportState;
-    viewportState.setViewportCount(1);
-    viewportState.setPViewports(&viewport);
-    viewportState.setScissorCount(1);
-    viewportState.setPScissors(&scissor);
-
-    //rasterizer
-    vk::PipelineRasterizationStateCreateInfo rasterizer;
-    rasterizer.setDepthClampEnable(false);
-    rasterizer.setRasterizerDiscardEnable(false);
-    rasterizer.setPolygonMode(vk::PolygonMode::eFill);
-    rasterizer.setLineWidth(1.f);
-    rasterizer.setCullMode(vk::CullModeFlagBits::eBack);
-    rasterizer.setFrontFace(vk::FrontFace::eCounterClockwise);
-    rasterizer.setDepthBiasEnable(false);
-    rasterizer.setDepthBiasConstantFactor(0.f);//optional
-    rasterizer.setDepthBiasClamp(0.f); //optional
-    rasterizer.setDepthBiasSlopeFactor(0.f); //optional
-
-    vk::PipelineMultisampleStateCreateInfo multisampling;
-    multisampling.setSampleShadingEnable(false);
-    multisampling.setRasterizationSamples(vk::SampleCountFlagBits::e1);
-    multisampling.setMinSampleShading(1.f);//optional
-    multisampling.setPSampleMask(nullptr); //optional
-    multisampling.setAlphaToCoverageEnable(false); //optional
-    multisampling.setAlphaToOneEnable(false); //optional
-
-    //options for alpha blending
-    vk::PipelineColorBlendAttachmentState colorBlendAttachment;
-    colorBlendAttachment.setColorWriteMask(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
-    colorBlendAttachment.setSrcColorBlendFactor(vk::BlendFactor::eSrcAlpha);
-    colorBlendAttachment.setDstColorBlendFactor(vk::BlendFactor::eOneMinusSrcAlpha);
-    colorBlendAttachment.setColorBlendOp(vk::BlendOp::eAdd);
-    colorBlendAttachment.setSrcAlphaBlendFactor(vk::BlendFactor::eOne);
-    colorBlendAttachment.setDstAlphaBlendFactor(vk::BlendFactor::eZero);
-    colorBlendAttachment.setAlphaBlendOp(vk::BlendOp::eAdd);
-
-    vk::PipelineColorBlendStateCreateInfo colorBlending;
-    colorBlending.setLogicOpEnable(false);
-    colorBlending.setLogicOp(vk::LogicOp::eCopy); //optional
-    colorBlending.setAttachmentCount(1);
-    colorBlending.setPAttachments(&colorBlendAttachment);
-    colorBlending.setBlendConstants({0.f, 0.f, 0.f, 0.f}); //optional
-
-    vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
-    pipelineLayoutInfo.setSetLayoutCount(1);
-    pipelineLayoutInfo.setPSetLayouts(&m_descriptorSetLayout);
-    pipelineLayoutInfo.setPushConstantRangeCount(0); //optional
-    pipelineLayoutInfo.setPPushConstantRanges(nullptr);//optional
-
-    vk::PipelineDepthStencilStateCreateInfo depthStencil;
-    depthStencil.setDepthTestEnable(true);
-    depthStencil.setDepthWriteEnable(true);
-    depthStencil.setDepthCompareOp(vk::CompareOp::eLess);
-    depthStencil.setDepthBoundsTestEnable(false);
-    depthStencil.setMinDepthBounds(0.f); //optional
-    depthStencil.setMaxDepthBounds(1.f); //optional
-    depthStencil.setStencilTestEnable(false);
-    depthStencil.setFront({}); //optional
-    depthStencil.setBack({}); //optional
-
-    m_pipelineLayout = m_device.createPipelineLayout(pipelineLayoutInfo);
-
-    //create pipeline from all infos
-    vk::GraphicsPipelineCreateInfo pipelineInfo;
-    pipelineInfo.setStageCount(shaderStages.size());
-    pipelineInfo.setPStages(shaderStages.data());
-    pipelineInfo.setPVertexInputState(&vertexInputInfo);
-    pipelineInfo.setPInputAssemblyState(&inputAssembly);
-    pipelineInfo.setPViewportState(&viewportState);
-    pipelineInfo.setPRasterizationState(&rasterizer);
-    pipelineInfo.setPMultisampleState(&multisampling);
-    pipelineInfo.setPDepthStencilState(&depthStencil);
-    pipelineInfo.setPColorBlendState(&colorBlending);
-    pipelineInfo.setPDynamicState(&dynamicState);
-    pipelineInfo.setLayout(m_pipelineLayout);
-    pipelineInfo.setRenderPass(m_renderPass);
-    pipelineInfo.setSubpass(0);
-    pipelineInfo.setBasePipelineHandle(VK_NULL_HANDLE); //optional
-    pipelineInfo.setBasePipelineIndex(-1); //optional
-
-    auto pipelineCreationResult = m_device.createGraphicsPipeline(VK_NULL_HANDLE, pipelineInfo);
-
-    if(pipelineCreationResult.result != vk::Result::eSuccess)
-        throw std::runtime_error("failed to create graphics pipeline");
-
-    m_graphicsPipeline = pipelineCreationResult.value;
-    //delete shader modules
-    m_device.destroyShaderModule(vertShaderModule);
-    m_device.destroyShaderModule(fragShaderModule);
+    return permutations;
 }
 
 void Application::createCommandPool()
@@ -732,7 +1203,18 @@ void Application::createCommandPool()
 
     m_commandPool = m_device.createCommandPool(poolInfo);
 
-    Renderer::Vulkan::RenderCommand::initRenderCommands(m_device, m_commandPool, m_graphicsQueue);
+    m_stagingPool.create(m_stagingPoolSize);
+    Renderer::Vulkan::RenderCommand::initRenderCommands(m_device, m_commandPool, m_graphicsQueue, m_stagingPool);
+
+    uint32_t graphicsFamily = queueFamilyIndices.graphicsFamily.value();
+    m_uploadManager.init(queueFamilyIndices.transferFamily.value_or(graphicsFamily), m_transferQueue, graphicsFamily, m_maxFramesInFlight);
+
+    //timestamp queries per frame in flight, upload batches time themselves through the same profiler
+    m_gpuProfiler.init(graphicsFamily, m_maxFramesInFlight);
+    m_uploadManager.setProfiler(&m_gpuProfiler, m_hostQueryReset);
+
+    //per thread, per frame pools for the secondary command buffers, cached recording adds per image ones
+    m_commandRecorder.init(graphicsFamily, m_threadPool.getThreadCount(), m_maxFramesInFlight);
 }
 
 void Application::createCommandBuffers()
@@ -747,6 +1229,55 @@ void Application::createCommandBuffers()
     m_commandBuffers = m_device.allocateCommandBuffers(allocInfo);
 }
 
+void Application::createCachedCommandBuffers()
+{
+    if(!m_cachedRecording)
+        return;
+
+    //old command buffers may still be executing, free them once everything submitted so far is done
+    if(!m_cachedCommandBuffers.empty())
+    {
+        m_frameScheduler.deferUntil(m_frameScheduler.getLastSubmittedValue(), [this, commandBuffers = std::move(m_cachedCommandBuffers)]()
+        {
+            m_device.freeCommandBuffers(m_commandPool, commandBuffers);
+        });
+        m_cachedCommandBuffers.clear();
+    }
+
+    //one per (frame in flight, swapchain image) pair, the descriptor set and framebuffer differ for each
+    vk::CommandBufferAllocateInfo allocInfo;
+    allocInfo.setCommandPool(m_commandPool);
+    allocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+    allocInfo.setCommandBufferCount(static_cast<uint32_t>(m_maxFramesInFlight * m_swapChainImages.size()));
+
+    m_cachedCommandBuffers = m_device.allocateCommandBuffers(allocInfo);
+    m_cachedVersions.assign(m_cachedCommandBuffers.size(), 0);
+    markSceneDirty();
+
+    //secondaries of every pair get their own pools too. slots only ever get added, so a pair keeps its slot
+    //across swapchain recreation and its old secondaries, possibly still executing, are never reset under it
+    m_commandRecorder.reserveSlots(static_cast<uint32_t>(m_cachedCommandBuffers.size()));
+}
+
+vk::CommandBuffer Application::getCachedCommandBuffer(uint32_t imageIndex)
+{
+    size_t imageCount = m_swapChainImages.size();
+    size_t slot = m_currentFrame * imageCount + imageIndex;
+
+    if(m_cachedVersions[slot] != m_sceneVersion)
+    {
+        //only this pair's secondaries are reset, the other cached command buffers stay valid. the pair was last
+        //submitted in this frame slot, which drawFrame already waited for
+        m_commandRecorder.beginSlot(m_currentFrame + m_maxFramesInFlight * imageIndex);
+
+        m_cachedCommandBuffers[slot].reset();
+        recordCommandBuffer(m_cachedCommandBuffers[slot], imageIndex);
+        m_cachedVersions[slot] = m_sceneVersion;
+    }
+
+    return m_cachedCommandBuffers[slot];
+}
+
 void Application::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex)
 {
     //begin recording command buffer 
@@ -755,6 +1286,15 @@ void Application::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t
 
     commandBuffer.begin(beginInfo);
 
+    //queries are reset in the command buffer itself, so cached command buffers keep producing timings
+    m_gpuProfiler.beginRecording(commandBuffer, m_currentFrame);
+    uint32_t frameScope = m_gpuProfiler.beginScope(commandBuffer, "frame");
+
+    //take ownership of anything the transfer queue uploaded since the last frame
+    //cached command buffers get these from a separate command buffer in drawFrame
+    if(!m_cachedRecording)
+        m_uploadManager.recordAcquireBarriers(commandBuffer);
+
     //fill out render pass info
     vk::ClearColorValue clearColor;
     clearColor.setFloat32({0.f, 0.f, 0.f, 1.f});
@@ -767,16 +1307,201 @@ void Application::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t
     renderArea.setOffset({0, 0});
     renderArea.setExtent(m_swapChainExtent);
 
-    vk::RenderPassBeginInfo renderPassInfo;
-    renderPassInfo.setRenderPass(m_renderPass);
-    renderPassInfo.setFramebuffer(m_swapChainFramebuffers[imageIndex]);
-    renderPassInfo.setRenderArea(renderArea);
-    renderPassInfo.setClearValueCount(static_cast<uint32_t>(clearValues.size()));
-    renderPassInfo.setPClearValues(clearValues.data());
+    //cull before the pass starts, the draws below only read the results
+    bool gpuCulling = m_gpuCuller.isEnabled();
+    if(gpuCulling)
+    {
+        uint32_t cullScope = m_gpuProfiler.beginScope(commandBuffer, "cull");
+        m_gpuCuller.recordCull(commandBuffer, m_currentFrame);
+        m_gpuProfiler.endScope(commandBuffer, cullScope);
+    }
+
+    //big scenes are split into chunks recorded into secondary command buffers on the thread pool
+    //with gpu culling there is a handful of draws however big the scene is, cpu culling still records every object
+    uint32_t objectCount = static_cast<uint32_t>(m_scene.objects.size());
+    bool parallel = !gpuCulling && m_parallelRecording && objectCount > m_recordChunkSize;
+
+    uint32_t passScope = m_gpuProfiler.beginScope(commandBuffer, "main pass");
+    if(m_dynamicRendering)
+    {
+        beginDynamicRendering(commandBuffer, imageIndex, renderArea, clearValues[0], clearValues[1],
+                              parallel ? vk::RenderingFlagBits::eContentsSecondaryCommandBuffers : vk::RenderingFlags());
+    }
+    else
+    {
+        vk::RenderPassBeginInfo renderPassInfo;
+        renderPassInfo.setRenderPass(m_renderPass);
+        renderPassInfo.setFramebuffer(m_swapChainFramebuffers[imageIndex]);
+        renderPassInfo.setRenderArea(renderArea);
+        renderPassInfo.setClearValueCount(static_cast<uint32_t>(clearValues.size()));
+        renderPassInfo.setPClearValues(clearValues.data());
+
+        commandBuffer.beginRenderPass(renderPassInfo, parallel ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline);
+    }
+
+    if(parallel)
+    {
+        //secondary command buffers must know what they will be executed inside of
+        vk::Format depthFormat = VulkanUtils::findDepthFormat(m_physicalDevice);
+        vk::CommandBufferInheritanceRenderingInfo inheritanceRenderingInfo;
+        inheritanceRenderingInfo.setColorAttachmentCount(1);
+        inheritanceRenderingInfo.setPColorAttachmentFormats(&m_swapChainImageFormat);
+        inheritanceRenderingInfo.setDepthAttachmentFormat(depthFormat);
+        inheritanceRenderingInfo.setRasterizationSamples(vk::SampleCountFlagBits::e1);
+
+        vk::CommandBufferInheritanceInfo inheritanceInfo;
+        if(m_dynamicRendering)
+        {
+            inheritanceInfo.setPNext(&inheritanceRenderingInfo);
+        }
+        else
+        {
+            inheritanceInfo.setRenderPass(m_renderPass);
+            inheritanceInfo.setSubpass(0);
+            inheritanceInfo.setFramebuffer(m_swapChainFramebuffers[imageIndex]);
+        }
+
+        const auto& secondaries = m_commandRecorder.record(objectCount, m_recordChunkSize, inheritanceInfo, m_threadPool,
+            [this](vk::CommandBuffer secondary, uint32_t begin, uint32_t end){ recordDraws(secondary, begin, end); });
+
+        commandBuffer.executeCommands(secondaries);
+    }
+    else if(gpuCulling)
+    {
+        recordIndirectDraws(commandBuffer);
+    }
+    else
+    {
+        recordDraws(commandBuffer, 0, objectCount);
+    }
+
+    //end recording
+    if(m_dynamicRendering)
+        endDynamicRendering(commandBuffer, imageIndex);
+    else
+        commandBuffer.endRenderPass();
+    m_gpuProfiler.endScope(commandBuffer, passScope);
+
+    m_gpuProfiler.endScope(commandBuffer, frameScope);
+    commandBuffer.end();
+}
+
+void Application::recordDraws(vk::CommandBuffer commandBuffer, uint32_t begin, uint32_t end)
+{
+    //secondary command buffers inherit no state, so every chunk binds everything itself
+    bindDrawState(commandBuffer);
+
+    //draw, pipeline and texture only rebind when they change from one object to the next (bindless: never)
+    //a new material is the same set 1 at another dynamic offset
+    vk::Pipeline boundPipeline;
+    uint32_t boundSet = UINT32_MAX;
+    uint32_t boundMaterial = UINT32_MAX;
+    for(uint32_t i = begin; i < end; i++)
+    {
+        const SceneObject& object = m_scene.objects[i];
+
+        vk::Pipeline pipeline = m_materialPipelines[object.material % m_materialPipelines.size()];
+        if(pipeline != boundPipeline)
+        {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+            boundPipeline = pipeline;
+        }
+
+        uint32_t set = getDescriptorSet(object.texture);
+        if(set != boundSet)
+        {
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, 1, &m_descriptorSets[set], 0, nullptr);
+            boundSet = set;
+        }
+
+        uint32_t material = object.material % m_scene.materialCount;
+        if(material != boundMaterial)
+        {
+            uint32_t materialOffset = material * m_materialStride;
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 1, 1, &m_materialDescriptorSet, 1, &materialOffset);
+            boundMaterial = material;
+        }
+
+        //per object data is pushed straight into the command buffer, no descriptor or buffer write per draw
+        ObjectConstants constants;
+        constants.model = object.model;
+        commandBuffer.pushConstants(m_pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(ObjectConstants), &constants);
+
+        //one draw for every instance of the mesh, the vertex shader fetches its transform with gl_InstanceIndex
+        //cpu culling takes the draw from this frame's draw list instead, culled objects have 0 instances there
+        if(m_cpuCulling)
+        {
+            vk::DeviceSize offset = (m_currentFrame * m_scene.objects.size() + i) * sizeof(vk::DrawIndexedIndirectCommand);
+            commandBuffer.drawIndexedIndirect(m_drawListBuffer.getHandle(), offset, 1, sizeof(vk::DrawIndexedIndirectCommand));
+        }
+        else
+        {
+            commandBuffer.drawIndexed(object.indexCount, object.instanceCount, object.firstIndex, object.vertexOffset, object.firstInstance);
+        }
+    }
+
+    m_recordedDrawCalls += end - begin;
+}
+
+void Application::recordIndirectDraws(vk::CommandBuffer commandBuffer)
+{
+    bindDrawState(commandBuffer);
+
+    //one indirect draw per bucket that has any objects, how many of them are drawn is up to the cull pass
+    uint32_t drawCalls = 0;
+    uint32_t setsPerFrame = getDescriptorSetsPerFrame();
 
-    commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_graphicsPipeline);
+    //objects can not push their own model matrix here, createGpuCulling only enables this when every one is identity
+    ObjectConstants constants;
+    commandBuffer.pushConstants(m_pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(ObjectConstants), &constants);
 
+    for(uint32_t material = 0; material < m_scene.materialCount; material++)
+    {
+        bool pipelineBound = false;
+        uint32_t boundSet = UINT32_MAX;
+        uint32_t materialOffset = material * m_materialStride;
+        for(uint32_t texture = 0; texture < setsPerFrame; texture++)
+        {
+            uint32_t bucket = material * setsPerFrame + texture;
+            if(m_gpuCuller.getBucketSize(bucket) == 0)
+                continue;
+
+            if(!pipelineBound)
+            {
+                commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_materialPipelines[material]);
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 1, 1, &m_materialDescriptorSet, 1, &materialOffset);
+                pipelineBound = true;
+            }
+
+            uint32_t set = getDescriptorSet(texture);
+            if(set != boundSet)
+            {
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, 1, &m_descriptorSets[set], 0, nullptr);
+                boundSet = set;
+            }
+
+            m_gpuCuller.recordDraw(commandBuffer, m_currentFrame, bucket);
+            drawCalls++;
+        }
+    }
+
+    m_recordedDrawCalls += drawCalls;
+}
+
+uint32_t Application::getDrawCallsPerFrame() const
+{
+    //cpu culling records every object, culled ones are draws with 0 instances
+    if(!m_gpuCuller.isEnabled())
+        return static_cast<uint32_t>(m_scene.objects.size());
+
+    uint32_t drawCalls = 0;
+    for(uint32_t bucket = 0; bucket < m_gpuCuller.getBucketCount(); bucket++)
+        drawCalls += m_gpuCuller.getBucketSize(bucket) > 0 ? 1 : 0;
+    return drawCalls;
+}
+
+void Application::bindDrawState(vk::CommandBuffer commandBuffer)
+{
     //viewport and scissor are dynamic so have to set each time
     vk::Viewport viewport;
     viewport.setX(0.f);
@@ -797,127 +1522,254 @@ void Application::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t
     vk::DeviceSize offsets[] = {0};
     commandBuffer.bindVertexBuffers(0, 1, vertexBuffers, offsets);
     commandBuffer.bindIndexBuffer(m_indexBuffer.getHandle(), 0, vk::IndexType::eUint32);
+}
+
+void Application::beginDynamicRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex, vk::Rect2D renderArea, vk::ClearValue colorClear, vk::ClearValue depthClear, vk::RenderingFlags flags)
+{
+    //what the render pass did implicitly: swapchain image to attachment layout (old contents are cleared anyway)
+    vk::ImageMemoryBarrier colorBarrier;
+    colorBarrier.setOldLayout(vk::ImageLayout::eUndefined);
+    colorBarrier.setNewLayout(vk::ImageLayout::eColorAttachmentOptimal);
+    colorBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    colorBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    colorBarrier.setImage(m_swapChainImages[imageIndex]);
+    colorBarrier.setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+    colorBarrier.setSrcAccessMask(vk::AccessFlagBits::eNone);
+    colorBarrier.setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
+
+    //depth is cleared every frame, so like the render pass it starts from undefined and the image
+    //never needs a separate (queue draining) transition when it is recreated. the previous frame's writes still have to finish first
+    vk::Format depthFormat = VulkanUtils::findDepthFormat(m_physicalDevice);
+    vk::ImageAspectFlags depthAspect = vk::ImageAspectFlagBits::eDepth;
+    if(VulkanUtils::hasStencilComponent(depthFormat))
+        depthAspect |= vk::ImageAspectFlagBits::eStencil;
+
+    vk::ImageMemoryBarrier depthBarrier;
+    depthBarrier.setOldLayout(vk::ImageLayout::eUndefined);
+    depthBarrier.setNewLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    depthBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    depthBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    depthBarrier.setImage(m_depthImage.getHandle());
+    depthBarrier.setSubresourceRange({depthAspect, 0, 1, 0, 1});
+    depthBarrier.setSrcAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+    depthBarrier.setDstAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+
+    std::array<vk::ImageMemoryBarrier, 2> barriers = {colorBarrier, depthBarrier};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests,
+                                  vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                                  {}, nullptr, nullptr, barriers);
+
+    vk::RenderingAttachmentInfo colorAttachment;
+    colorAttachment.setImageView(m_swapChainImageViews[imageIndex]);
+    colorAttachment.setImageLayout(vk::ImageLayout::eColorAttachmentOptimal);
+    colorAttachment.setLoadOp(vk::AttachmentLoadOp::eClear);
+    colorAttachment.setStoreOp(vk::AttachmentStoreOp::eStore);
+    colorAttachment.setClearValue(colorClear);
 
-    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, 1, &m_descriptorSets[m_currentFrame], 0, nullptr);
+    vk::RenderingAttachmentInfo depthAttachment;
+    depthAttachment.setImageView(m_depthImage.getImageView());
+    depthAttachment.setImageLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    depthAttachment.setLoadOp(vk::AttachmentLoadOp::eClear);
+    depthAttachment.setStoreOp(vk::AttachmentStoreOp::eDontCare);
+    depthAttachment.setClearValue(depthClear);
 
-    //draw
-    commandBuffer.drawIndexed(static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+    vk::RenderingInfo renderingInfo;
+    renderingInfo.setFlags(flags);
+    renderingInfo.setRenderArea(renderArea);
+    renderingInfo.setLayerCount(1);
+    renderingInfo.setColorAttachmentCount(1);
+    renderingInfo.setPColorAttachments(&colorAttachment);
+    renderingInfo.setPDepthAttachment(&depthAttachment);
 
-    //end recording
-    commandBuffer.endRenderPass();
+    Renderer::Vulkan::DynamicRendering::beginRendering(commandBuffer, renderingInfo);
+}
 
-    commandBuffer.end();
+void Application::endDynamicRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    Renderer::Vulkan::DynamicRendering::endRendering(commandBuffer);
+
+    //hand the image to the presentation engine, the semaphore signal covers the memory dependency
+    //headless readback makes the writes visible itself, see saveOffscreenImage
+    vk::ImageMemoryBarrier presentBarrier;
+    presentBarrier.setOldLayout(vk::ImageLayout::eColorAttachmentOptimal);
+    presentBarrier.setNewLayout(getTargetFinalLayout());
+    presentBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    presentBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    presentBarrier.setImage(m_swapChainImages[imageIndex]);
+    presentBarrier.setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+    presentBarrier.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
+    presentBarrier.setDstAccessMask(vk::AccessFlagBits::eNone);
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eBottomOfPipe,
+                                  {}, nullptr, nullptr, presentBarrier);
 }
 
 void Application::createSyncObjects()
 {
     m_imageAvailableSemaphores.resize(m_maxFramesInFlight);
     m_renderFinishedSemaphores.resize(m_maxFramesInFlight);
-    m_inFlightFences.resize(m_maxFramesInFlight);
 
+    //the swapchain only works with binary semaphores, cpu/gpu sync goes through the timeline
     vk::SemaphoreCreateInfo semaphoreInfo;
 
-    vk::FenceCreateInfo fenceInfo;
-    fenceInfo.setFlags(vk::FenceCreateFlagBits::eSignaled);
-
     for(int i = 0; i < m_maxFramesInFlight; i++)
     {
         m_imageAvailableSemaphores[i] = m_device.createSemaphore(semaphoreInfo);
         m_renderFinishedSemaphores[i] = m_device.createSemaphore(semaphoreInfo);
-        m_inFlightFences[i] = m_device.createFence(fenceInfo);
     }
+
+    m_frameScheduler.init(m_maxFramesInFlight);
 }
 
 void Application::createVertexBuffer()
 {
-    vk::DeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-    Renderer::Vulkan::Buffer stagingBuff(m_device, m_physicalDevice);
-    stagingBuff.create(bufferSize, vk::BufferUsageFlagBits::eTransferSrc, 
-                       vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    vk::DeviceSize bufferSize = sizeof(m_scene.vertices[0]) * m_scene.vertices.size();
 
-    stagingBuff.allocateAndMap<Vertex>(vertices);
+    auto staging = Renderer::Vulkan::RenderCommand::getStagingPool().write(m_scene.vertices.data(), bufferSize);
 
     m_vertexBuffer.create(bufferSize,
                 vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
                 vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    m_vertexBuffer.copyBuffer(stagingBuff);
-    stagingBuff.free();
+    m_vertexBuffer.copyFrom(staging.buffer, staging.offset, bufferSize);
 }
 
 void Application::createIndexBuffer()
 {
     //same as vertex buffer
-    vk::DeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+    vk::DeviceSize bufferSize = sizeof(m_scene.indices[0]) * m_scene.indices.size();
 
-    Renderer::Vulkan::Buffer stagingBuff(m_device, m_physicalDevice);
-    stagingBuff.create(bufferSize, vk::BufferUsageFlagBits::eTransferSrc,
-                       vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-    stagingBuff.allocateAndMap<uint32_t>(indices);
+    auto staging = Renderer::Vulkan::RenderCommand::getStagingPool().write(m_scene.indices.data(), bufferSize);
 
     m_indexBuffer.create(bufferSize,
                           vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
                           vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    m_indexBuffer.copyBuffer(stagingBuff);
-    stagingBuff.free();
+    m_indexBuffer.copyFrom(staging.buffer, staging.offset, bufferSize);
 }
 
-void Application::createUniformBuffers()
+void Application::createInstanceBuffer()
+{
+    //static per instance data, read as a storage buffer rather than a per instance vertex stream
+    vk::DeviceSize bufferSize = sizeof(m_scene.instances[0]) * m_scene.instances.size();
+
+    auto staging = Renderer::Vulkan::RenderCommand::getStagingPool().write(m_scene.instances.data(), bufferSize);
+
+    m_instanceBuffer.create(bufferSize,
+                            vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+                            vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    m_instanceBuffer.copyFrom(staging.buffer, staging.offset, bufferSize);
+}
+
+void Application::createMaterialBuffer()
 {
-    vk::DeviceSize bufferSize = sizeof(UniformBufferObject);
+    //every block starts on the dynamic offset alignment
+    vk::DeviceSize alignment = m_physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment;
+    m_materialStride = static_cast<uint32_t>((sizeof(MaterialUniforms) + alignment - 1) / alignment * alignment);
 
-    m_uniformBuffers.resize(m_maxFramesInFlight);
-    for(size_t i = 0; i < m_maxFramesInFlight; i++)
+    std::vector<uint8_t> blocks(static_cast<size_t>(m_materialStride) * m_scene.materialCount);
+    for(uint32_t i = 0; i < m_scene.materialCount; i++)
     {
-        m_uniformBuffers[i].setDevices(m_device, m_physicalDevice);
-        m_uniformBuffers[i].create(bufferSize,
-                       vk::BufferUsageFlagBits::eUniformBuffer,
-                       vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        MaterialUniforms material;
+        material.color = i < m_scene.materialColors.size() ? m_scene.materialColors[i] : glm::vec4(1.f);
+        memcpy(&blocks[static_cast<size_t>(i) * m_materialStride], &material, sizeof(material));
     }
+
+    auto staging = Renderer::Vulkan::RenderCommand::getStagingPool().write(blocks.data(), blocks.size());
+
+    m_materialBuffer.create(static_cast<uint32_t>(blocks.size()),
+                            vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eUniformBuffer,
+                            vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    m_materialBuffer.copyFrom(staging.buffer, staging.offset, blocks.size());
+}
+
+void Application::createUniformBuffers()
+{
+    //one region per frame in flight, the ubo of frame i always sits at the start of region i
+    m_uniformRing.create(m_uniformRingRegionSize, m_maxFramesInFlight, vk::BufferUsageFlagBits::eUniformBuffer);
 }
 
 void Application::createDescriptorPool()
 {
-    std::array<vk::DescriptorPoolSize, 2> poolSizes;
+    //one set per frame in flight per scene texture, bindless has a single set per frame holding the whole texture array
+    uint32_t setCount = m_maxFramesInFlight * getDescriptorSetsPerFrame();
+    uint32_t samplersPerSet = m_bindless ? m_bindlessTextureCount : 1;
+
+    std::array<vk::DescriptorPoolSize, 3> poolSizes;
     poolSizes[0].setType(vk::DescriptorType::eUniformBuffer);
-    poolSizes[0].setDescriptorCount(m_maxFramesInFlight);
+    poolSizes[0].setDescriptorCount(setCount);
     poolSizes[1].setType(vk::DescriptorType::eCombinedImageSampler);
-    poolSizes[1].setDescriptorCount(m_maxFramesInFlight);
+    poolSizes[1].setDescriptorCount(setCount * samplersPerSet);
+    poolSizes[2].setType(vk::DescriptorType::eStorageBuffer);
+    poolSizes[2].setDescriptorCount(setCount);
 
     vk::DescriptorPoolCreateInfo poolInfo;
+    if(m_bindless)
+        poolInfo.setFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
     poolInfo.setPoolSizeCount(static_cast<uint32_t>(poolSizes.size()));
     poolInfo.setPPoolSizes(poolSizes.data());
-    poolInfo.setMaxSets(m_maxFramesInFlight);
+    poolInfo.setMaxSets(setCount);
 
     m_descriptorPool = m_device.createDescriptorPool(poolInfo);
+
+    //the material set never changes, one is enough for every frame in flight
+    vk::DescriptorPoolSize materialPoolSize;
+    materialPoolSize.setType(vk::DescriptorType::eUniformBufferDynamic);
+    materialPoolSize.setDescriptorCount(1);
+
+    vk::DescriptorPoolCreateInfo materialPoolInfo;
+    materialPoolInfo.setPoolSizeCount(1);
+    materialPoolInfo.setPPoolSizes(&materialPoolSize);
+    materialPoolInfo.setMaxSets(1);
+
+    m_materialDescriptorPool = m_device.createDescriptorPool(materialPoolInfo);
 }
 
 void Application::createDescriptorSets()
 {
-    std::vector<vk::DescriptorSetLayout> layouts(m_maxFramesInFlight, m_descriptorSetLayout);
+    //[frame * textureCount + texture], bindless: [frame]
+    uint32_t setsPerFrame = getDescriptorSetsPerFrame();
+    uint32_t setCount = m_maxFramesInFlight * setsPerFrame;
+    std::vector<vk::DescriptorSetLayout> layouts(setCount, m_descriptorSetLayout);
     vk::DescriptorSetAllocateInfo allocInfo;
     allocInfo.setDescriptorPool(m_descriptorPool);
-    allocInfo.setDescriptorSetCount(m_maxFramesInFlight);
+    allocInfo.setDescriptorSetCount(setCount);
     allocInfo.setPSetLayouts(layouts.data());
 
     m_descriptorSets = m_device.allocateDescriptorSets(allocInfo);
 
-    for(size_t i = 0; i < m_maxFramesInFlight; i++)
+    for(size_t i = 0; i < setCount; i++)
     {
+        uint32_t frame = static_cast<uint32_t>(i) / setsPerFrame;
+        uint32_t firstTexture = static_cast<uint32_t>(i) % setsPerFrame;
+        uint32_t textureCount = m_bindless ? m_scene.textureCount : 1;
+
         vk::DescriptorBufferInfo bufferInfo;
-        bufferInfo.setBuffer(m_uniformBuffers[i].getHandle());
-        bufferInfo.setOffset(0);
+        bufferInfo.setBuffer(m_uniformRing.getHandle());
+        bufferInfo.setOffset(m_uniformRing.getRegionOffset(frame));
         bufferInfo.setRange(sizeof(UniformBufferObject));
 
-        vk::DescriptorImageInfo imageInfo;
-        imageInfo.setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
-        imageInfo.setImageView(m_texture.getImageView());
-        imageInfo.setSampler(m_texture.getSampler());
+        //bindless writes every scene texture, the rest of the array stays unbound (partially bound)
+        std::vector<vk::DescriptorImageInfo> imageInfos;
+        for(uint32_t texture = firstTexture; texture < firstTexture + textureCount; texture++)
+        {
+            Renderer::Vulkan::Texture& sampled = texture == 0 ? m_texture : m_sceneTextures[texture - 1];
+
+            vk::DescriptorImageInfo imageInfo;
+            imageInfo.setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+            imageInfo.setImageView(sampled.getImageView());
+            imageInfo.setSampler(sampled.getSampler());
+            imageInfos.push_back(imageInfo);
+        }
 
-        std::array<vk::WriteDescriptorSet, 2> descriptorWrites;
+        vk::DescriptorBufferInfo instanceInfo;
+        instanceInfo.setBuffer(m_instanceBuffer.getHandle());
+        instanceInfo.setOffset(0);
+        instanceInfo.setRange(VK_WHOLE_SIZE);
+
+        std::array<vk::WriteDescriptorSet, 3> descriptorWrites;
         descriptorWrites[0].setDstSet(m_descriptorSets[i]);
         descriptorWrites[0].setDstBinding(0);
         descriptorWrites[0].setDstArrayElement(0);
@@ -929,16 +1781,157 @@ void Application::createDescriptorSets()
         descriptorWrites[1].setDstBinding(1);
         descriptorWrites[1].setDstArrayElement(0);
         descriptorWrites[1].setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
-        descriptorWrites[1].setDescriptorCount(1);
-        descriptorWrites[1].setPImageInfo(&imageInfo);
+        descriptorWrites[1].setDescriptorCount(static_cast<uint32_t>(imageInfos.size()));
+        descriptorWrites[1].setPImageInfo(imageInfos.data());
+
+        descriptorWrites[2].setDstSet(m_descriptorSets[i]);
+        descriptorWrites[2].setDstBinding(2);
+        descriptorWrites[2].setDstArrayElement(0);
+        descriptorWrites[2].setDescriptorType(vk::DescriptorType::eStorageBuffer);
+        descriptorWrites[2].setDescriptorCount(1);
+        descriptorWrites[2].setPBufferInfo(&instanceInfo);
 
         m_device.updateDescriptorSets(descriptorWrites, {});
     }
+
+    vk::DescriptorSetAllocateInfo materialAllocInfo;
+    materialAllocInfo.setDescriptorPool(m_materialDescriptorPool);
+    materialAllocInfo.setDescriptorSetCount(1);
+    materialAllocInfo.setPSetLayouts(&m_materialSetLayout);
+
+    m_materialDescriptorSet = m_device.allocateDescriptorSets(materialAllocInfo)[0];
+
+    //the range is one block, the dynamic offset moves it
+    vk::DescriptorBufferInfo materialInfo;
+    materialInfo.setBuffer(m_materialBuffer.getHandle());
+    materialInfo.setOffset(0);
+    materialInfo.setRange(sizeof(MaterialUniforms));
+
+    vk::WriteDescriptorSet materialWrite;
+    materialWrite.setDstSet(m_materialDescriptorSet);
+    materialWrite.setDstBinding(0);
+    materialWrite.setDstArrayElement(0);
+    materialWrite.setDescriptorType(vk::DescriptorType::eUniformBufferDynamic);
+    materialWrite.setDescriptorCount(1);
+    materialWrite.setPBufferInfo(&materialInfo);
+
+    m_device.updateDescriptorSets(materialWrite, {});
+}
+
+void Application::createGpuCulling()
+{
+    if(!m_drawIndirectCount)
+        return;
+
+    //one push constant per bucket, per object model matrices would need a draw each
+    for(const auto& object : m_scene.objects)
+    {
+        if(object.model != glm::mat4(1.f))
+        {
+            std::cout << "gpu culling disabled, scene objects have their own model matrices\n";
+            return;
+        }
+    }
+
+    std::vector<Renderer::Vulkan::CullObject> objects;
+    objects.reserve(m_scene.objects.size());
+    for(const auto& object : m_scene.objects)
+    {
+        Renderer::Vulkan::CullObject cullObject;
+        cullObject.sphere = m_scene.getObjectBounds(object);
+        cullObject.firstIndex = object.firstIndex;
+        cullObject.indexCount = object.indexCount;
+        cullObject.vertexOffset = object.vertexOffset;
+        cullObject.firstInstance = object.firstInstance;
+        cullObject.instanceCount = object.instanceCount;
+        cullObject.bucket = getDrawBucket(object);
+        objects.push_back(cullObject);
+    }
+
+    //the frustum comes from the same ubo the vertex shader uses, so cached command buffers stay valid
+    std::vector<vk::DescriptorBufferInfo> frameUniforms;
+    for(uint32_t i = 0; i < m_maxFramesInFlight; i++)
+        frameUniforms.emplace_back(m_uniformRing.getHandle(), m_uniformRing.getRegionOffset(i), sizeof(UniformBufferObject));
+
+    m_gpuCuller.init(objects, m_scene.materialCount * getDescriptorSetsPerFrame(), frameUniforms, "res/shaders/cull.spv", m_pipelineDiskCache.getHandle());
+}
+
+void Application::createCpuCulling()
+{
+    //the gpu culler already skips invisible objects, testing them twice gains nothing
+    m_cpuCulling = m_settings.cpuCulling && !m_gpuCuller.isEnabled();
+    if(m_settings.cpuCulling && !m_cpuCulling)
+        std::cout << "cpu culling disabled, gpu culling is enabled\n";
+    if(m_cpuCulling && !m_drawIndirectFirstInstance)
+    {
+        std::cout << "drawIndirectFirstInstance is not supported, cpu culling is off\n";
+        m_cpuCulling = false;
+    }
+
+    //--bvh on its own is only used for picking
+    if(!m_cpuCulling && !m_settings.bvh)
+        return;
+
+    //objects never move, so their world space spheres are only computed once
+    std::vector<glm::vec4> spheres;
+    spheres.reserve(m_scene.objects.size());
+    for(const auto& object : m_scene.objects)
+        spheres.push_back(m_scene.getObjectBounds(object));
+
+    if(m_settings.bvh)
+    {
+        auto buildStart = std::chrono::high_resolution_clock::now();
+        m_bvh.build(spheres);
+        double buildTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+        std::cout << "bvh over " << m_bvh.getObjectCount() << " objects, " << m_bvh.getNodeCount() << " nodes, depth "
+                  << m_bvh.getDepth() << ", built in " << buildTime << "ms\n";
+    }
+
+    if(m_cpuCulling && m_settings.bvh)
+    {
+        std::cout << "cpu culling " << m_bvh.getObjectCount() << " objects through the bvh\n";
+    }
+    else if(m_cpuCulling)
+    {
+        m_frustumCuller.setSpheres(spheres);
+        std::cout << "cpu culling " << m_frustumCuller.getCount() << " objects, " << Utils::FrustumCuller::getInstructionSet()
+                  << " (" << Utils::FrustumCuller::getSimdWidth() << " wide) on " << m_threadPool.getThreadCount() << " threads\n";
+    }
+
+    if(!m_cpuCulling)
+        return;
+
+    //one indirect draw per object and frame in flight, every object starts out culled until the first cullObjects
+    size_t objectCount = m_scene.objects.size();
+    m_drawListBuffer.create(static_cast<uint32_t>(objectCount * m_maxFramesInFlight * sizeof(vk::DrawIndexedIndirectCommand)),
+                            vk::BufferUsageFlagBits::eIndirectBuffer,
+                            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    auto* commands = static_cast<vk::DrawIndexedIndirectCommand*>(m_drawListBuffer.getMappedData());
+    for(uint32_t frame = 0; frame < m_maxFramesInFlight; frame++)
+    {
+        for(size_t i = 0; i < objectCount; i++)
+        {
+            const SceneObject& object = m_scene.objects[i];
+            commands[frame * objectCount + i] = vk::DrawIndexedIndirectCommand(object.indexCount, 0, object.firstIndex, object.vertexOffset, object.firstInstance);
+        }
+    }
+    m_drawListVisible.assign(m_maxFramesInFlight, {});
 }
 
 void Application::createTextureImage()
 {
     m_texture.create("res/textures/test.png", vk::Filter::eNearest, vk::SamplerAddressMode::eRepeat);
+
+    //generated scene textures go through the upload manager, the first frame acquires them
+    m_sceneTextures.clear();
+    m_sceneTextures.reserve(m_scene.textureCount - 1);
+    for(uint32_t i = 1; i < m_scene.textureCount; i++)
+    {
+        std::vector<uint8_t> pixels = Scene::generateTexturePixels(i, m_generatedTextureSize);
+        auto& texture = m_sceneTextures.emplace_back(m_device, m_physicalDevice);
+        texture.create(pixels.data(), m_generatedTextureSize, m_generatedTextureSize, vk::Filter::eNearest, vk::SamplerAddressMode::eRepeat, m_uploadManager);
+    }
 }
 
 void Application::createDepthResources()
@@ -950,14 +1943,5 @@ void Application::createDepthResources()
                               vk::ImageUsageFlagBits::eDepthStencilAttachment, 
                               vk::MemoryPropertyFlagBits::eDeviceLocal,
                               vk::ImageAspectFlagBits::eDepth);
-    m_depthImage.transitionImageLayout(depthFormat, vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal);
-}
-
-vk::ShaderModule Application::createShaderModule(const std::vector<char>& code)
-{
-    vk::ShaderModuleCreateInfo createInfo{};
-    createInfo.setCodeSize(code.size());
-    createInfo.setPCode(reinterpret_cast<const uint32_t*>(code.data()));
-
-    return m_device.createShaderModule(createInfo);
+    //no layout transition, both rendering paths take the image from undefined every frame
 }
@@ -3,14 +3,35 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
+#include <string>
 
 #include <vulkan/vulkan.hpp>
 
 #include "Renderer/Vulkan/Image.h"
 #include "Renderer/Vulkan/Buffer.h"
 #include "Renderer/Vulkan/Texture.h"
+#include "Renderer/Vulkan/RingBuffer.h"
+#include "Renderer/Vulkan/UploadManager.h"
+#include "Renderer/Vulkan/StagingPool.h"
+#include "Renderer/Vulkan/PipelineDiskCache.h"
+#include "Renderer/Vulkan/PipelineCache.h"
+#include "Renderer/Vulkan/ParallelCommandRecorder.h"
+#include "Renderer/Vulkan/FrameScheduler.h"
+#include "Renderer/Vulkan/FramePacer.h"
+#include "Renderer/Vulkan/PresentFences.h"
+#include "Renderer/Vulkan/GpuProfiler.h"
+#include "Renderer/Vulkan/GpuCuller.h"
+
+#include "RenderSettings.h"
+#include "Scene.h"
+
+#include "utils/ThreadPool.h"
+#include "utils/FrameStats.h"
+#include "utils/FrustumCulling.h"
+#include "utils/Bvh.h"
 
 struct Vertex;
 struct UniformBufferObject;
@@ -18,20 +39,37 @@ struct UniformBufferObject;
 class Application
 {
 public:
-    Application();
+    Application(const RenderSettings& settings = RenderSettings(), const Scene& scene = Scene::createDefault());
     ~Application();
     void update();
 
+    //results of the last update(), used by the benchmark
+    const Utils::FrameStats& getFrameStats() const { return m_frameStats; }
+    uint32_t getFramesRendered() const { return m_framesRendered; }
+    double getRunTime() const { return m_runTime; }
+    uint64_t getRecordedDrawCalls() const { return m_recordedDrawCalls.load(); }
+    uint32_t getDrawCallsPerFrame() const;
+    //cpu culling: objects that passed the last frame's cull, otherwise every object
+    uint32_t getVisibleObjectCount() const { return static_cast<uint32_t>(m_cpuCulling ? m_visibleObjects.size() : m_scene.objects.size()); }
+    const Scene& getScene() const { return m_scene; }
+
     static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 private:
     void drawFrame();
+    void dumpFrameStats();
+    void updateCamera();
     void updateUniformBuffer(uint32_t currentImage);
+    void cullObjects();
+    void pickObject();
     void recreateSwapChain();
 
     void initVulkan();
     void initGlfw();
     void cleanup();
-    void cleanupSwapChain();
+    //hands the swapchain and everything sized to it to deferred destruction, frames in flight keep using them
+    void retireSwapChain();
+    bool isMinimized() const { int width = 0, height = 0; glfwGetFramebufferSize(m_window, &width, &height); return width == 0 || height == 0; }
 
     void createInstance();
     void setupDebugMessenger();
@@ -40,33 +78,57 @@ private:
 
     void createSurface();
     void createSwapChain();
+    void createOffscreenTargets();
     void createImageViews();
     void createFramebuffers();
+    //what the color target is left in after a frame: present src, or transfer src for headless readback
+    vk::ImageLayout getTargetFinalLayout() const { return m_headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR; }
+    void saveOffscreenImage(const std::string& filename);
 
     void createRenderPass();
     void createDescriptorSetLayout();
+    void createPipelineCache();
     void createGraphicsPipeline();
+    std::vector<Renderer::Vulkan::PipelineState> getPipelinePermutations();
 
     void createCommandPool();
     void createCommandBuffers();
+    void createCachedCommandBuffers();
+    vk::CommandBuffer getCachedCommandBuffer(uint32_t imageIndex);
+    void markSceneDirty() { m_sceneVersion++; }
     void recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex);
+    //begin/end index the draw list, i.e. the visible objects with cpu culling
+    void recordDraws(vk::CommandBuffer commandBuffer, uint32_t begin, uint32_t end);
+    void recordIndirectDraws(vk::CommandBuffer commandBuffer);
+    void bindDrawState(vk::CommandBuffer commandBuffer);
+    //objects with the same pipeline and texture share a bucket
+    uint32_t getDrawBucket(const SceneObject& object) const { return (object.material % m_scene.materialCount) * getDescriptorSetsPerFrame() + (m_bindless ? 0 : object.texture % m_scene.textureCount); }
+    //descriptor set to draw texture with in the current frame, bindless has one set per frame
+    uint32_t getDescriptorSetsPerFrame() const { return m_bindless ? 1 : m_scene.textureCount; }
+    uint32_t getDescriptorSet(uint32_t texture) const { return m_currentFrame * getDescriptorSetsPerFrame() + (m_bindless ? 0 : texture % m_scene.textureCount); }
+    void beginDynamicRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex, vk::Rect2D renderArea, vk::ClearValue colorClear, vk::ClearValue depthClear, vk::RenderingFlags flags);
+    void endDynamicRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex);
     void createSyncObjects();
 
     void createVertexBuffer();
     void createIndexBuffer();
+    void createInstanceBuffer();
+    void createMaterialBuffer();
     void createUniformBuffers();
     void createDescriptorPool();
     void createDescriptorSets();
+    void createGpuCulling();
+    void createCpuCulling();
 
     void createTextureImage();
+    void createMaterialPipelines();
     void createDepthResources();
 
-    //shader
-    vk::ShaderModule createShaderModule(const std::vector<char>& code);
+    //declared first so they are initialised before any member that reads them
+    const RenderSettings m_settings;
+    const uint32_t m_maxFramesInFlight;
 
-    GLFWwindow* m_window;
-    const uint32_t m_windowHeight = 600;
-    const uint32_t m_windowWidth  = 800;
+    GLFWwindow* m_window = nullptr; //null when headless
 
     vk::Instance m_instance;
     vk::PhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
@@ -74,6 +136,7 @@ private:
 
     vk::Queue m_graphicsQueue;
     vk::Queue m_presentQueue;
+    vk::Queue m_transferQueue; //same as graphics queue if there is no transfer only family
 
     vk::SurfaceKHR m_surface;
     vk::SwapchainKHR m_swapChain;
@@ -84,29 +147,100 @@ private:
 
     std::vector<vk::Framebuffer> m_swapChainFramebuffers;
 
-    vk::RenderPass m_renderPass;
+    //headless: offscreen color targets stand in for the swapchain images, handed out round robin
+    const bool m_headless;
+    std::vector<Renderer::Vulkan::Image> m_offscreenImages;
+    uint32_t m_offscreenIndex = 0;
+    const uint32_t m_defaultHeadlessFrames = 1000;
+
+    vk::RenderPass m_renderPass; //null with dynamic rendering
+    const bool m_preferDynamicRendering = true; //use VK_KHR_dynamic_rendering when the device supports it
+    bool m_dynamicRendering = false;
 
     vk::DescriptorSetLayout m_descriptorSetLayout;
     vk::DescriptorPool m_descriptorPool;
     vk::PipelineLayout m_pipelineLayout;
     std::vector<vk::DescriptorSet> m_descriptorSets;
+    //set 1, material blocks behind a dynamic offset. dynamic buffers are not allowed in update after bind layouts,
+    //so they live outside the bindless set in their own layout and pool
+    vk::DescriptorSetLayout m_materialSetLayout;
+    vk::DescriptorPool m_materialDescriptorPool;
+    vk::DescriptorSet m_materialDescriptorSet;
+    bool m_bindless = false; //settings.bindless and the device supports descriptor indexing
+    const uint32_t m_maxBindlessTextures = 4096; //array size, clamped to the device limit
+    uint32_t m_bindlessTextureCount = 0;
+    const std::string m_bindlessFragShader = "res/shaders/frag_bindless.spv";
 
     vk::Pipeline m_graphicsPipeline;
+    std::vector<Renderer::Vulkan::PipelineState> m_materialStates; //permutations, material i uses i % size
+    std::vector<vk::Pipeline> m_materialPipelines; //one per scene material
+    Renderer::Vulkan::PipelineDiskCache m_pipelineDiskCache;
+    const std::string m_pipelineCacheFile = "pipeline_cache.bin";
+    Renderer::Vulkan::PipelineCache m_pipelineCache;
+    Utils::ThreadPool m_threadPool;
+    const bool m_parallelPipelineCompilation = true; //compile the permutations the scene uses on m_threadPool at startup
 
     vk::CommandPool m_commandPool;
     std::vector<vk::CommandBuffer> m_commandBuffers;
+    Renderer::Vulkan::ParallelCommandRecorder m_commandRecorder;
+    const bool m_parallelRecording = true; //record draws into secondary command buffers on m_threadPool
+    const uint32_t m_recordChunkSize = 2048; //draws per secondary command buffer
+    std::atomic<uint64_t> m_recordedDrawCalls{0}; //across all recordings, cached command buffers record once
+
+    //static scenes reuse pre-recorded command buffers until the scene version changes
+    const bool m_cachedRecording = true;
+    std::vector<vk::CommandBuffer> m_cachedCommandBuffers; //[frame * imageCount + image]
+    std::vector<uint64_t> m_cachedVersions; //scene version each cached command buffer was recorded at, 0 = never
+    uint64_t m_sceneVersion = 1;
 
     std::vector<vk::Semaphore> m_imageAvailableSemaphores;
     std::vector<vk::Semaphore> m_renderFinishedSemaphores;
-    std::vector<vk::Fence> m_inFlightFences;
+    Renderer::Vulkan::FrameScheduler m_frameScheduler;
+    Renderer::Vulkan::FramePacer m_framePacer;
+    Renderer::Vulkan::PresentFences m_presentFences; //retired swapchains wait for their presents, not for the queue
+    bool m_surfaceMaintenance = false; //VK_EXT_surface_maintenance1 enabled on the instance, present fences need it
+    Renderer::Vulkan::GpuProfiler m_gpuProfiler;
+    const double m_gpuStatsInterval = 5.0; //seconds between gpu timing prints
+    Renderer::Vulkan::GpuCuller m_gpuCuller; //replaces per object draws when enabled
+    bool m_drawIndirectCount = false; //device feature, only enabled with settings.gpuCulling
+    bool m_hostQueryReset = false; //device feature, enabled if available for timing uploads on a transfer only queue
+    Utils::FrustumCuller m_frustumCuller; //world space object spheres, tested on m_threadPool before recording
+    Utils::Bvh m_bvh; //settings.bvh, replaces m_frustumCuller and answers picking rays
+    std::vector<uint32_t> m_visibleObjects; //scene objects visible this frame, in scene order (bvh: tree order)
+    //cpu culling: a VkDrawIndexedIndirectCommand per object and frame in flight, the recorded draws read them so a changed
+    //visible set only rewrites instance counts. culled objects stay in the command buffers as draws with 0 instances
+    Renderer::Vulkan::Buffer m_drawListBuffer;
+    std::vector<std::vector<uint32_t>> m_drawListVisible; //objects with instances in each frame's draw list
+    bool m_cpuCulling = false; //settings.cpuCulling unless the gpu culls
+    bool m_drawIndirectFirstInstance = false; //device feature, needed by both culling paths
+    glm::mat4 m_view = glm::mat4(1.f); //camera of the current frame, shared by the ubo and the cpu frustum
+    glm::mat4 m_proj = glm::mat4(1.f);
+    bool m_pickRequested = false; //left click since the last frame, at m_pickX/m_pickY in window coordinates
+    double m_pickX = 0.0;
+    double m_pickY = 0.0;
+    Utils::FrameStats m_frameStats;
+    Utils::FrameTimings m_frameTimings; //filled in by drawFrame, recorded by update
+    uint32_t m_framesRendered = 0;
+    double m_runTime = 0.0; //seconds
     bool m_framebufferResized = false;
     uint32_t m_currentFrame = 0;
 
     Renderer::Vulkan::Buffer m_vertexBuffer;
     Renderer::Vulkan::Buffer m_indexBuffer;
-    std::vector<Renderer::Vulkan::Buffer> m_uniformBuffers;
+    Renderer::Vulkan::Buffer m_instanceBuffer; //InstanceData per instance, binding 2
+    Renderer::Vulkan::Buffer m_materialBuffer; //MaterialUniforms per material, set 1 binding 0 (dynamic offset)
+    uint32_t m_materialStride = 0; //MaterialUniforms rounded up to minUniformBufferOffsetAlignment
+    Renderer::Vulkan::RingBuffer m_uniformRing;
+    const vk::DeviceSize m_uniformRingRegionSize = 64 * 1024;
+
+    Renderer::Vulkan::UploadManager m_uploadManager;
+    Renderer::Vulkan::StagingPool m_stagingPool; //used by RenderCommand single time copies
+    const vk::DeviceSize m_stagingPoolSize = 32 * 1024 * 1024;
 
-    Renderer::Vulkan::Texture m_texture;
+    Scene m_scene; //one draw per object
+    Renderer::Vulkan::Texture m_texture; //scene texture 0
+    std::vector<Renderer::Vulkan::Texture> m_sceneTextures; //generated scene textures 1..textureCount-1
+    const uint32_t m_generatedTextureSize = 256;
     Renderer::Vulkan::Image m_depthImage;
 
     VkDebugUtilsMessengerEXT m_debugMessenger;
@@ -121,5 +255,5 @@ private:
     {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     };
-    const uint32_t m_maxFramesInFlight = 3;
+    bool m_pipelineCreationFeedback = false; //VK_EXT_pipeline_creation_feedback, enabled if available
 };
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "RenderSettings.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+RenderSettings RenderSettings::fromArgs(int argc, char** argv)
+{
+    RenderSettings settings;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if(arg == "--present" && hasValue)
+        {
+            std::string mode = argv[++i];
+            if(mode == "immediate")
+                settings.presentMode = vk::PresentModeKHR::eImmediate;
+            else if(mode == "mailbox")
+                settings.presentMode = vk::PresentModeKHR::eMailbox;
+            else if(mode == "fifo")
+                settings.presentMode = vk::PresentModeKHR::eFifo;
+            else if(mode == "fifo_relaxed")
+                settings.presentMode = vk::PresentModeKHR::eFifoRelaxed;
+            else
+                std::cout << "unknown present mode " << mode << "\n";
+        }
+        else if(arg == "--frames-in-flight" && hasValue)
+        {
+            settings.framesInFlight = std::clamp(parseInt(arg, argv[++i], settings.framesInFlight), 1, 8);
+        }
+        else if(arg == "--images" && hasValue)
+        {
+            settings.swapChainImages = static_cast<uint32_t>(std::max(0, parseInt(arg, argv[++i], settings.swapChainImages)));
+        }
+        else if(arg == "--max-fps" && hasValue)
+        {
+            settings.maxFps = std::max(0.0, parseDouble(arg, argv[++i], settings.maxFps));
+        }
+        else if(arg == "--present-wait")
+        {
+            settings.presentWait = true;
+            if(hasValue && argv[i + 1][0] != '-')
+                settings.presentWaitLatency = static_cast<uint32_t>(std::max(1, parseInt(arg, argv[++i], settings.presentWaitLatency)));
+        }
+        else if(arg == "--stats" && hasValue)
+        {
+            std::string name = argv[++i];
+            settings.statsFile = name == "off" ? "" : name;
+        }
+        else if(arg == "--headless")
+        {
+            settings.headless = true;
+        }
+        else if(arg == "--size" && hasValue)
+        {
+            std::string size = argv[++i];
+            size_t separator = size.find('x');
+            if(separator != std::string::npos)
+            {
+                settings.width = static_cast<uint32_t>(std::max(1, parseInt(arg, size.substr(0, separator), settings.width)));
+                settings.height = static_cast<uint32_t>(std::max(1, parseInt(arg, size.substr(separator + 1), settings.height)));
+            }
+            else
+            {
+                std::cout << "size has to be WIDTHxHEIGHT, got " << size << "\n";
+            }
+        }
+        else if(arg == "--frames" && hasValue)
+        {
+            settings.frameCount = static_cast<uint32_t>(std::max(0, parseInt(arg, argv[++i], settings.frameCount)));
+        }
+        else if(arg == "--output" && hasValue)
+        {
+            settings.outputImage = argv[++i];
+        }
+        else if(arg == "--gpu-culling")
+        {
+            settings.gpuCulling = true;
+        }
+        else if(arg == "--cpu-culling")
+        {
+            settings.cpuCulling = true;
+        }
+        else if(arg == "--bvh")
+        {
+            settings.bvh = true;
+        }
+        else if(arg == "--bindless")
+        {
+            settings.bindless = true;
+        }
+        else
+        {
+            std::cout << "unknown argument " << arg << "\n";
+        }
+    }
+
+    return settings;
+}
+
+std::string RenderSettings::toString() const
+{
+    std::stringstream stream;
+    stream << "present mode: " << vk::to_string(presentMode)
+           << ", frames in flight: " << framesInFlight
+           << ", swapchain images: " << (swapChainImages ? std::to_string(swapChainImages) : "auto")
+           << ", max fps: " << (maxFps > 0.0 ? std::to_string(maxFps) : "off")
+           << ", present wait: " << (presentWait ? std::to_string(presentWaitLatency) : "off")
+           << ", frame stats: " << (statsFile.empty() ? "off" : statsFile)
+           << ", " << (headless ? "headless " : "window ") << width << "x" << height
+           << ", frames: " << (frameCount ? std::to_string(frameCount) : (headless ? "1000" : "unlimited"))
+           << ", gpu culling: " << (gpuCulling ? "on" : "off")
+           << ", cpu culling: " << (cpuCulling ? "on" : "off")
+           << ", bvh: " << (bvh ? "on" : "off")
+           << ", bindless: " << (bindless ? "on" : "off");
+    return stream.str();
+}
+
+int RenderSettings::parseInt(const std::string& flag, const std::string& value, int fallback)
+{
+    try
+    {
+        return std::stoi(value);
+    }
+    catch(const std::exception&)
+    {
+        //std::invalid_argument or std::out_of_range
+        std::cout << "invalid value for " << flag << ": " << value << "\n";
+        return fallback;
+    }
+}
+
+double RenderSettings::parseDouble(const std::string& flag, const std::string& value, double fallback)
+{
+    try
+    {
+        return std::stod(value);
+    }
+    catch(const std::exception&)
+    {
+        std::cout << "invalid value for " << flag << ": " << value << "\n";
+        return fallback;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <vulkan/vulkan.hpp>
+
+//runtime options picked per deployment, trades throughput against input to photon latency
+struct RenderSettings
+{
+	//falls back to fifo (always supported) when the surface does not offer it
+	vk::PresentModeKHR presentMode = vk::PresentModeKHR::eMailbox;
+	uint32_t framesInFlight = 3;
+	uint32_t swapChainImages = 0; //0 = minImageCount + 1
+	double maxFps = 0.0; //cpu frame limiter, 0 = off
+	bool presentWait = false; //VK_KHR_present_wait pacing, ignored if unsupported
+	uint32_t presentWaitLatency = 1; //frames allowed between present and display before the cpu waits
+	std::string statsFile = "frame_stats"; //cpu frame stats go to <statsFile>.csv/.json on exit, empty = off
+
+	//headless renders into offscreen images, no window, surface or VK_KHR_swapchain (works on lavapipe)
+	bool headless = false;
+	uint32_t width = 800;
+	uint32_t height = 600;
+	uint32_t frameCount = 0; //stop after this many frames, 0 = until the window is closed (headless: 1000)
+	std::string outputImage; //headless only, the last frame is written here as a .ppm
+
+	//frustum culling in a compute pass and drawIndexedIndirectCount, cpu draws if the device can not do it
+	bool gpuCulling = false;
+	//simd frustum culling of object spheres on the thread pool, culled objects draw 0 instances from a per frame draw list
+	bool cpuCulling = false;
+	//bvh over the scene objects: cpu culling walks it instead of testing every object, left click picks an object
+	bool bvh = false;
+	//every texture in one descriptor indexing array, one descriptor set per frame instead of one per texture
+	bool bindless = false;
+
+	//--present immediate|mailbox|fifo|fifo_relaxed --frames-in-flight n --images n --max-fps n --present-wait [latency]
+	//--stats name|off --headless --size WxH --frames n --output file.ppm --gpu-culling --cpu-culling --bvh --bindless
+	static RenderSettings fromArgs(int argc, char** argv);
+	std::string toString() const;
+
+	//std::stoi/stod that print "invalid value for <flag>" and return fallback instead of throwing
+	static int parseInt(const std::string& flag, const std::string& value, int fallback);
+	static double parseDouble(const std::string& flag, const std::string& value, double fallback);
+};
@@ -1,5 +1,7 @@
 #include "Buffer.h"
 
+#include <algorithm>
+
 #include "utils/VulkanUtils.h"
 #include "RenderCommand.h"
 #include "Vertex.h"
@@ -9,29 +11,38 @@ Renderer::Vulkan::Buffer::Buffer(vk::Device& device, vk::PhysicalDevice& physica
 {
 }
 
-void Renderer::Vulkan::Buffer::create(uint32_t bufferSize, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties)
+void Renderer::Vulkan::Buffer::create(uint32_t bufferSize, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, std::vector<uint32_t> queueFamilies)
 {
     m_size = bufferSize;
 
+    //the same family twice is not allowed in a concurrent buffer
+    std::sort(queueFamilies.begin(), queueFamilies.end());
+    queueFamilies.erase(std::unique(queueFamilies.begin(), queueFamilies.end()), queueFamilies.end());
+    m_concurrent = queueFamilies.size() > 1;
+
     //create buffer
     vk::BufferCreateInfo bufferInfo;
     bufferInfo.setSize(m_size);
     bufferInfo.setUsage(usage);
-    bufferInfo.setSharingMode(vk::SharingMode::eExclusive);
+    if(m_concurrent)
+    {
+        bufferInfo.setSharingMode(vk::SharingMode::eConcurrent);
+        bufferInfo.setQueueFamilyIndices(queueFamilies);
+    }
+    else
+    {
+        bufferInfo.setSharingMode(vk::SharingMode::eExclusive);
+    }
 
     m_buffer = m_device->createBuffer(bufferInfo);
 
     //reserve (gpu) memory
     vk::MemoryRequirements memRequirements = m_device->getBufferMemoryRequirements(m_buffer);
 
-    vk::MemoryAllocateInfo allocInfo;
-    allocInfo.setAllocationSize(memRequirements.size);
-    allocInfo.setMemoryTypeIndex(VulkanUtils::findMemoryType(memRequirements.memoryTypeBits, properties, *m_physicalDevice));
-
-    m_memory = m_device->allocateMemory(allocInfo);
+    m_allocation = MemoryAllocator::allocate(memRequirements, properties, true);
 
     //bind memory and buffer
-    m_device->bindBufferMemory(m_buffer, m_memory, 0);
+    m_device->bindBufferMemory(m_buffer, m_allocation.memory, m_allocation.offset);
 }
 
 void Renderer::Vulkan::Buffer::copyBuffer(const Buffer& other)
@@ -45,6 +56,18 @@ void Renderer::Vulkan::Buffer::copyBuffer(const Buffer& other)
     Renderer::Vulkan::RenderCommand::endSingleTimeCommands(commandBuffer);
 }
 
+void Renderer::Vulkan::Buffer::copyFrom(vk::Buffer src, vk::DeviceSize srcOffset, vk::DeviceSize size)
+{
+    vk::CommandBuffer commandBuffer = Renderer::Vulkan::RenderCommand::beginSingleTimeCommands();
+
+    vk::BufferCopy copyRegion;
+    copyRegion.setSrcOffset(srcOffset);
+    copyRegion.setSize(size);
+    commandBuffer.copyBuffer(src, m_buffer, copyRegion);
+
+    Renderer::Vulkan::RenderCommand::endSingleTimeCommands(commandBuffer);
+}
+
 void Renderer::Vulkan::Buffer::free()
 {
     if(m_device == nullptr || m_physicalDevice == nullptr || m_size == 0)
@@ -56,7 +79,7 @@ void Renderer::Vulkan::Buffer::free()
     }
 
     m_device->destroyBuffer(m_buffer);
-    m_device->freeMemory(m_memory);
+    MemoryAllocator::free(m_allocation);
     m_device = nullptr;
     m_physicalDevice = nullptr;
     m_size = 0;
@@ -2,8 +2,12 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <vector>
+
 #include <stb_image.h>
 
+#include "MemoryAllocator.h"
+
 namespace Renderer::Vulkan
 {
 	class Buffer
@@ -12,27 +16,31 @@ namespace Renderer::Vulkan
 		Buffer() = default;
 		Buffer(vk::Device& device, vk::PhysicalDevice& physicalDevice);
 
-		void create(uint32_t bufferSize, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties);
+		//more than one distinct queue family makes the buffer concurrent, those queues use it without ownership transfers
+		void create(uint32_t bufferSize, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, std::vector<uint32_t> queueFamilies = {});
 		void copyBuffer(const Buffer& other);
+		void copyFrom(vk::Buffer src, vk::DeviceSize srcOffset, vk::DeviceSize size);
 		void free();
 
 		vk::Buffer getHandle() const { return m_buffer; }
+		vk::DeviceSize getSize() const { return m_size; }
+		bool isConcurrent() const { return m_concurrent; }
+		void* getMappedData() const { return m_allocation.mapped; }
 
 		void setDevices(vk::Device& device, vk::PhysicalDevice& physicalDevice) { m_device = &device; m_physicalDevice = &physicalDevice; }
 
 		template<typename T>
 		void allocateAndMap(const std::vector<T>& data)
 		{
-			//allocate memory and transfer to gpu
-			void* allocated = m_device->mapMemory(m_memory, 0, m_size);
-			memcpy(allocated, data.data(), static_cast<size_t>(m_size));
-			m_device->unmapMemory(m_memory);
+			//host visible memory is persistently mapped by the allocator
+			memcpy(m_allocation.mapped, data.data(), static_cast<size_t>(m_size));
 		}
 	private:
 		vk::DeviceSize m_size = 0;
+		bool m_concurrent = false;
 
 		vk::Buffer m_buffer;
-		vk::DeviceMemory m_memory;
+		Allocation m_allocation;
 
 		vk::Device* m_device = nullptr;
 		vk::PhysicalDevice* m_physicalDevice = nullptr;
@@ -0,0 +1,40 @@
+#include "DescriptorIndexing.h"
+
+#include <algorithm>
+
+bool Renderer::Vulkan::DescriptorIndexing::isSupported(vk::PhysicalDevice physicalDevice, uint32_t textureCount)
+{
+    if(physicalDevice.getProperties().apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    const auto& vulkan12Features = features.get<vk::PhysicalDeviceVulkan12Features>();
+
+    return vulkan12Features.descriptorIndexing
+        && vulkan12Features.runtimeDescriptorArray
+        && vulkan12Features.shaderSampledImageArrayNonUniformIndexing
+        && vulkan12Features.descriptorBindingPartiallyBound
+        && vulkan12Features.descriptorBindingSampledImageUpdateAfterBind
+        && getMaxTextureCount(physicalDevice) >= textureCount;
+}
+
+void Renderer::Vulkan::DescriptorIndexing::enableFeatures(vk::PhysicalDeviceVulkan12Features& features)
+{
+    features.setDescriptorIndexing(true);
+    features.setRuntimeDescriptorArray(true);
+    features.setShaderSampledImageArrayNonUniformIndexing(true);
+    features.setDescriptorBindingPartiallyBound(true);
+    features.setDescriptorBindingSampledImageUpdateAfterBind(true);
+}
+
+uint32_t Renderer::Vulkan::DescriptorIndexing::getMaxTextureCount(vk::PhysicalDevice physicalDevice)
+{
+    auto properties = physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+    const auto& vulkan12Properties = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+
+    //a combined image sampler counts against both the sampler and the sampled image limits
+    return std::min({vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                     vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                     vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers,
+                     vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages});
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+
+//descriptor indexing (VK_EXT_descriptor_indexing, core in vulkan 1.2) for a bindless texture array:
+//one partially bound, update after bind array of combined image samplers that shaders index with a non uniform integer
+namespace Renderer::Vulkan
+{
+	class DescriptorIndexing
+	{
+	public:
+		DescriptorIndexing() = delete; //static helpers only
+
+		//every feature enableFeatures turns on, and room for at least textureCount samplers
+		static bool isSupported(vk::PhysicalDevice physicalDevice, uint32_t textureCount);
+		static void enableFeatures(vk::PhysicalDeviceVulkan12Features& features);
+
+		//most samplers an update after bind array visible to the fragment stage can hold on this device
+		static uint32_t getMaxTextureCount(vk::PhysicalDevice physicalDevice);
+	};
+}
@@ -0,0 +1,67 @@
+#include "DynamicRendering.h"
+
+#include <stdexcept>
+
+#include "utils/VulkanUtils.h"
+
+PFN_vkCmdBeginRendering Renderer::Vulkan::DynamicRendering::m_sBeginRendering = nullptr;
+PFN_vkCmdEndRendering Renderer::Vulkan::DynamicRendering::m_sEndRendering = nullptr;
+
+bool Renderer::Vulkan::DynamicRendering::isSupported(vk::PhysicalDevice physicalDevice)
+{
+    //the feature can only be queried through vkGetPhysicalDeviceFeatures2
+    if(physicalDevice.getProperties().apiVersion < VK_API_VERSION_1_1)
+        return false;
+
+    std::vector<const char*> extensions;
+    addRequiredExtensions(physicalDevice, extensions);
+    if(!extensions.empty() && !VulkanUtils::checkDeviceExtensionSupport(physicalDevice, extensions))
+        return false;
+
+    auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDynamicRenderingFeatures>();
+    return features.get<vk::PhysicalDeviceDynamicRenderingFeatures>().dynamicRendering;
+}
+
+void Renderer::Vulkan::DynamicRendering::addRequiredExtensions(vk::PhysicalDevice physicalDevice, std::vector<const char*>& extensions)
+{
+    if(isCore(physicalDevice))
+        return;
+
+    //VK_KHR_dynamic_rendering and everything it depends on below 1.3
+    extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    extensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+    extensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+    extensions.push_back(VK_KHR_MULTIVIEW_EXTENSION_NAME);
+    extensions.push_back(VK_KHR_MAINTENANCE_2_EXTENSION_NAME);
+}
+
+void Renderer::Vulkan::DynamicRendering::init(vk::Device device)
+{
+    //core names first, the KHR aliases are only exposed by the extension
+    m_sBeginRendering = reinterpret_cast<PFN_vkCmdBeginRendering>(device.getProcAddr("vkCmdBeginRendering"));
+    m_sEndRendering = reinterpret_cast<PFN_vkCmdEndRendering>(device.getProcAddr("vkCmdEndRendering"));
+
+    if(!m_sBeginRendering || !m_sEndRendering)
+    {
+        m_sBeginRendering = reinterpret_cast<PFN_vkCmdBeginRendering>(device.getProcAddr("vkCmdBeginRenderingKHR"));
+        m_sEndRendering = reinterpret_cast<PFN_vkCmdEndRendering>(device.getProcAddr("vkCmdEndRenderingKHR"));
+    }
+
+    if(!m_sBeginRendering || !m_sEndRendering)
+        throw std::runtime_error("failed to load dynamic rendering functions!");
+}
+
+void Renderer::Vulkan::DynamicRendering::beginRendering(vk::CommandBuffer commandBuffer, const vk::RenderingInfo& renderingInfo)
+{
+    m_sBeginRendering(static_cast<VkCommandBuffer>(commandBuffer), reinterpret_cast<const VkRenderingInfo*>(&renderingInfo));
+}
+
+void Renderer::Vulkan::DynamicRendering::endRendering(vk::CommandBuffer commandBuffer)
+{
+    m_sEndRendering(static_cast<VkCommandBuffer>(commandBuffer));
+}
+
+bool Renderer::Vulkan::DynamicRendering::isCore(vk::PhysicalDevice physicalDevice)
+{
+    return physicalDevice.getProperties().apiVersion >= VK_API_VERSION_1_3;
+}
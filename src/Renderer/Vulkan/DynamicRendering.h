@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+//VK_KHR_dynamic_rendering (core in vulkan 1.3), rendering without vk::RenderPass/vk::Framebuffer objects
+//the entry points are loaded per device so it works on 1.3 devices and on older ones exposing the extension
+namespace Renderer::Vulkan
+{
+	class DynamicRendering
+	{
+	public:
+		DynamicRendering() = delete; //static helpers only
+
+		static bool isSupported(vk::PhysicalDevice physicalDevice);
+
+		//appends the device extensions needed when dynamic rendering is not core on this device
+		static void addRequiredExtensions(vk::PhysicalDevice physicalDevice, std::vector<const char*>& extensions);
+
+		//call after the device was created with the feature enabled
+		static void init(vk::Device device);
+		static bool isEnabled() { return m_sBeginRendering != nullptr; }
+
+		static void beginRendering(vk::CommandBuffer commandBuffer, const vk::RenderingInfo& renderingInfo);
+		static void endRendering(vk::CommandBuffer commandBuffer);
+	private:
+		static bool isCore(vk::PhysicalDevice physicalDevice);
+
+		static PFN_vkCmdBeginRendering m_sBeginRendering;
+		static PFN_vkCmdEndRendering m_sEndRendering;
+	};
+}
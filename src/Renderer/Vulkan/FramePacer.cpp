@@ -0,0 +1,86 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "utils/VulkanUtils.h"
+
+Renderer::Vulkan::FramePacer::FramePacer(vk::Device& device)
+    :m_device(device)
+{
+}
+
+bool Renderer::Vulkan::FramePacer::isPresentWaitSupported(vk::PhysicalDevice physicalDevice)
+{
+    std::vector<const char*> extensions;
+    addPresentWaitExtensions(extensions);
+    if(!VulkanUtils::checkDeviceExtensionSupport(physicalDevice, extensions))
+        return false;
+
+    auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR>();
+    return features.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId
+        && features.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+}
+
+void Renderer::Vulkan::FramePacer::addPresentWaitExtensions(std::vector<const char*>& extensions)
+{
+    extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+    extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+}
+
+void Renderer::Vulkan::FramePacer::init(bool presentWait, uint32_t presentWaitLatency, double maxFps)
+{
+    //extension function, not exported by the loader
+    m_waitForPresent = presentWait ? reinterpret_cast<PFN_vkWaitForPresentKHR>(m_device.getProcAddr("vkWaitForPresentKHR")) : nullptr;
+    m_presentWaitLatency = std::max(1u, presentWaitLatency);
+    m_presentId = 0;
+
+    m_minFrameTime = std::chrono::steady_clock::duration(0);
+    if(maxFps > 0.0)
+        m_minFrameTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / maxFps));
+    m_nextFrame = std::chrono::steady_clock::now();
+}
+
+void Renderer::Vulkan::FramePacer::waitForNextFrame(vk::SwapchainKHR swapChain)
+{
+    //don't start a frame while more than presentWaitLatency presents are still waiting to be displayed
+    if(m_waitForPresent && m_presentId > m_presentWaitLatency)
+    {
+        //a timeout keeps a minimised or occluded window from hanging, out of date is handled by present
+        const uint64_t timeout = 100 * 1000 * 1000;
+        m_waitForPresent(static_cast<VkDevice>(m_device), static_cast<VkSwapchainKHR>(swapChain), m_presentId - m_presentWaitLatency, timeout);
+    }
+
+    if(m_minFrameTime.count() > 0)
+    {
+        //sleep most of the way, then spin, sleep granularity is too coarse for high frame rates
+        auto now = std::chrono::steady_clock::now();
+        if(m_nextFrame - now > std::chrono::milliseconds(2))
+            std::this_thread::sleep_until(m_nextFrame - std::chrono::milliseconds(1));
+
+        while(std::chrono::steady_clock::now() < m_nextFrame)
+            std::this_thread::yield();
+
+        //don't try to catch up after a long frame
+        now = std::chrono::steady_clock::now();
+        m_nextFrame += m_minFrameTime;
+        if(m_nextFrame < now)
+            m_nextFrame = now + m_minFrameTime;
+    }
+}
+
+const vk::PresentIdKHR* Renderer::Vulkan::FramePacer::getPresentId()
+{
+    if(!m_waitForPresent)
+        return nullptr;
+
+    m_presentId++;
+    m_presentIdInfo.setSwapchainCount(1);
+    m_presentIdInfo.setPPresentIds(&m_presentId);
+    return &m_presentIdInfo;
+}
+
+void Renderer::Vulkan::FramePacer::onSwapChainRecreated()
+{
+    m_presentId = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+//paces the cpu before each frame: optional VK_KHR_present_wait (wait until an earlier present is on screen)
+//and an optional cpu frame limiter, both off by default
+namespace Renderer::Vulkan
+{
+	class FramePacer
+	{
+	public:
+		FramePacer(vk::Device& device);
+
+		//needs VK_KHR_present_id and VK_KHR_present_wait plus their features
+		static bool isPresentWaitSupported(vk::PhysicalDevice physicalDevice);
+		static void addPresentWaitExtensions(std::vector<const char*>& extensions);
+
+		//presentWait: the device was created with the present wait features enabled
+		void init(bool presentWait, uint32_t presentWaitLatency, double maxFps);
+
+		//call before any cpu work for the frame
+		void waitForNextFrame(vk::SwapchainKHR swapChain);
+
+		//chain the returned info into vk::PresentInfoKHR, nullptr when present wait is off
+		const vk::PresentIdKHR* getPresentId();
+
+		//present ids are per swapchain
+		void onSwapChainRecreated();
+
+		bool isPresentWaitEnabled() const { return m_waitForPresent != nullptr; }
+	private:
+		PFN_vkWaitForPresentKHR m_waitForPresent = nullptr;
+		uint32_t m_presentWaitLatency = 1;
+		uint64_t m_presentId = 0;
+		vk::PresentIdKHR m_presentIdInfo;
+
+		std::chrono::steady_clock::duration m_minFrameTime{0};
+		std::chrono::steady_clock::time_point m_nextFrame;
+
+		vk::Device& m_device;
+	};
+}
@@ -0,0 +1,147 @@
+#include "FrameScheduler.h"
+
+#include <stdexcept>
+
+Renderer::Vulkan::FrameScheduler::FrameScheduler(vk::Device& device)
+    :m_device(device)
+{
+}
+
+bool Renderer::Vulkan::FrameScheduler::isSupported(vk::PhysicalDevice physicalDevice)
+{
+    if(physicalDevice.getProperties().apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceTimelineSemaphoreFeatures>();
+    return features.get<vk::PhysicalDeviceTimelineSemaphoreFeatures>().timelineSemaphore;
+}
+
+void Renderer::Vulkan::FrameScheduler::init(uint32_t framesInFlight)
+{
+    vk::SemaphoreTypeCreateInfo typeInfo;
+    typeInfo.setSemaphoreType(vk::SemaphoreType::eTimeline);
+    typeInfo.setInitialValue(0);
+
+    vk::SemaphoreCreateInfo semaphoreInfo;
+    semaphoreInfo.setPNext(&typeInfo);
+
+    m_timeline = m_device.createSemaphore(semaphoreInfo);
+    m_nextValue = 1;
+    m_frameValues.assign(framesInFlight, 0);
+}
+
+void Renderer::Vulkan::FrameScheduler::free()
+{
+    if(!m_timeline)
+        return;
+
+    wait(getLastSubmittedValue());
+
+    //nothing else will be submitted, so work deferred past the last submit can run as well
+    std::deque<Deferred> deferred = std::move(m_deferred);
+    m_deferred.clear();
+    for(auto& entry : deferred)
+        entry.func();
+
+    m_device.destroySemaphore(m_timeline);
+    m_timeline = nullptr;
+}
+
+void Renderer::Vulkan::FrameScheduler::beginFrame(uint32_t frameIndex)
+{
+    m_frameIndex = frameIndex;
+    wait(m_frameValues[m_frameIndex]);
+    collect();
+}
+
+uint64_t Renderer::Vulkan::FrameScheduler::submit(vk::Queue queue, const std::vector<vk::CommandBuffer>& commandBuffers,
+                                                  const std::vector<vk::Semaphore>& waitSemaphores,
+                                                  const std::vector<vk::PipelineStageFlags>& waitStages,
+                                                  const std::vector<vk::Semaphore>& signalSemaphores)
+{
+    uint64_t value = m_nextValue++;
+
+    //binary semaphores ignore their value, the timeline always goes last
+    std::vector<uint64_t> waitValues(waitSemaphores.size(), 0);
+
+    std::vector<vk::Semaphore> signals = signalSemaphores;
+    signals.push_back(m_timeline);
+    std::vector<uint64_t> signalValues(signals.size(), 0);
+    signalValues.back() = value;
+
+    vk::TimelineSemaphoreSubmitInfo timelineInfo;
+    timelineInfo.setWaitSemaphoreValueCount(static_cast<uint32_t>(waitValues.size()));
+    timelineInfo.setPWaitSemaphoreValues(waitValues.data());
+    timelineInfo.setSignalSemaphoreValueCount(static_cast<uint32_t>(signalValues.size()));
+    timelineInfo.setPSignalSemaphoreValues(signalValues.data());
+
+    vk::SubmitInfo submitInfo;
+    submitInfo.setPNext(&timelineInfo);
+    submitInfo.setWaitSemaphoreCount(static_cast<uint32_t>(waitSemaphores.size()));
+    submitInfo.setPWaitSemaphores(waitSemaphores.data());
+    submitInfo.setPWaitDstStageMask(waitStages.data());
+    submitInfo.setCommandBufferCount(static_cast<uint32_t>(commandBuffers.size()));
+    submitInfo.setPCommandBuffers(commandBuffers.data());
+    submitInfo.setSignalSemaphoreCount(static_cast<uint32_t>(signals.size()));
+    submitInfo.setPSignalSemaphores(signals.data());
+
+    queue.submit(submitInfo);
+
+    m_frameValues[m_frameIndex] = value;
+    return value;
+}
+
+void Renderer::Vulkan::FrameScheduler::wait(uint64_t value)
+{
+    if(value == 0 || isComplete(value))
+        return;
+
+    vk::SemaphoreWaitInfo waitInfo;
+    waitInfo.setSemaphoreCount(1);
+    waitInfo.setPSemaphores(&m_timeline);
+    waitInfo.setPValues(&value);
+
+    if(m_device.waitSemaphores(waitInfo, UINT64_MAX) != vk::Result::eSuccess)
+        throw std::runtime_error("failed to wait for timeline semaphore!");
+}
+
+bool Renderer::Vulkan::FrameScheduler::isComplete(uint64_t value)
+{
+    return getCompletedValue() >= value;
+}
+
+uint64_t Renderer::Vulkan::FrameScheduler::getCompletedValue()
+{
+    return m_device.getSemaphoreCounterValue(m_timeline);
+}
+
+void Renderer::Vulkan::FrameScheduler::deferUntil(uint64_t value, std::function<void()> func)
+{
+    m_deferred.push_back({value, std::move(func)});
+}
+
+void Renderer::Vulkan::FrameScheduler::collect()
+{
+    if(m_deferred.empty())
+        return;
+
+    //values are mostly pushed in order, but scan everything so an out of order value never blocks the rest
+    //finished work is moved out first so callbacks are free to defer more work
+    uint64_t completed = getCompletedValue();
+    std::vector<std::function<void()>> finished;
+    for(auto it = m_deferred.begin(); it != m_deferred.end();)
+    {
+        if(it->value <= completed)
+        {
+            finished.push_back(std::move(it->func));
+            it = m_deferred.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for(auto& func : finished)
+        func();
+}
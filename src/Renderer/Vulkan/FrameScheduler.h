@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+//tracks gpu progress with one timeline semaphore (vulkan 1.2), every submit signals the next value
+//frame slots, deferred deletion and anything else can wait on an exact value instead of owning fences
+//all submits have to go to the same queue so the values are signalled in order
+namespace Renderer::Vulkan
+{
+	class FrameScheduler
+	{
+	public:
+		FrameScheduler(vk::Device& device);
+
+		static bool isSupported(vk::PhysicalDevice physicalDevice);
+
+		void init(uint32_t framesInFlight);
+		void free();
+
+		//waits until the last submit made from this frame slot has finished, then runs finished deferred work
+		void beginFrame(uint32_t frameIndex);
+
+		//can be called any number of times per frame, returns the value signalled when the work is done
+		//binary semaphores (swapchain) can be waited on and signalled alongside the timeline
+		uint64_t submit(vk::Queue queue, const std::vector<vk::CommandBuffer>& commandBuffers,
+		                const std::vector<vk::Semaphore>& waitSemaphores = {},
+		                const std::vector<vk::PipelineStageFlags>& waitStages = {},
+		                const std::vector<vk::Semaphore>& signalSemaphores = {});
+
+		void wait(uint64_t value);
+		bool isComplete(uint64_t value);
+		uint64_t getCompletedValue();
+
+		//value the next submit will signal, i.e. covers everything recorded so far
+		uint64_t getPendingValue() const { return m_nextValue; }
+		uint64_t getLastSubmittedValue() const { return m_nextValue - 1; }
+
+		//runs func once the gpu has reached value, checked in beginFrame
+		void deferUntil(uint64_t value, std::function<void()> func);
+		//runs func once everything submitted so far and the next submit have finished
+		void deferUntilSubmitted(std::function<void()> func) { deferUntil(m_nextValue, std::move(func)); }
+
+		vk::Semaphore getTimeline() const { return m_timeline; }
+	private:
+		void collect();
+
+		struct Deferred
+		{
+			uint64_t value;
+			std::function<void()> func;
+		};
+
+		vk::Semaphore m_timeline;
+		uint64_t m_nextValue = 1;
+		uint32_t m_frameIndex = 0;
+		std::vector<uint64_t> m_frameValues; //last value submitted from each frame slot
+		std::deque<Deferred> m_deferred;
+
+		vk::Device& m_device;
+	};
+}
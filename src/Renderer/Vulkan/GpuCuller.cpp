@@ -0,0 +1,247 @@
+#include "GpuCuller.h"
+
+#include <array>
+#include <iostream>
+#include <stdexcept>
+
+#include "RenderCommand.h"
+#include "StagingPool.h"
+
+#include "utils/MappedFile.h"
+
+Renderer::Vulkan::GpuCuller::GpuCuller(vk::Device& device, vk::PhysicalDevice& physicalDevice)
+    :m_objectBuffer(device, physicalDevice), m_device(device), m_physicalDevice(physicalDevice)
+{
+}
+
+bool Renderer::Vulkan::GpuCuller::isSupported(vk::PhysicalDevice physicalDevice)
+{
+    if(physicalDevice.getProperties().apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    //the commands keep each object's firstInstance, its instances start there in the instance buffer
+    auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    return features.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount && features.get<vk::PhysicalDeviceFeatures2>().features.drawIndirectFirstInstance;
+}
+
+void Renderer::Vulkan::GpuCuller::init(const std::vector<CullObject>& objects, uint32_t bucketCount, const std::vector<vk::DescriptorBufferInfo>& frameUniforms,
+                                       const std::string& shaderFile, vk::PipelineCache pipelineCache)
+{
+    if(objects.empty() || bucketCount == 0)
+        return;
+
+    try
+    {
+        createPipeline(shaderFile, pipelineCache);
+    }
+    catch(const std::exception& e)
+    {
+        std::cout << "gpu culling disabled, " << e.what() << " " << shaderFile << "\n";
+        free();
+        return;
+    }
+
+    //counting sort by bucket so every bucket's commands end up next to each other
+    m_objectCount = static_cast<uint32_t>(objects.size());
+    m_bucketOffsets.assign(bucketCount + 1, 0);
+    for(const auto& object : objects)
+        m_bucketOffsets[object.bucket + 1]++;
+    for(uint32_t i = 0; i < bucketCount; i++)
+        m_bucketOffsets[i + 1] += m_bucketOffsets[i];
+
+    std::vector<CullObject> sorted(objects.size());
+    std::vector<uint32_t> next(m_bucketOffsets.begin(), m_bucketOffsets.end() - 1);
+    for(const auto& object : objects)
+    {
+        CullObject& slot = sorted[next[object.bucket]++];
+        slot = object;
+        slot.commandOffset = m_bucketOffsets[object.bucket];
+    }
+
+    //objects never change, they are uploaded once
+    vk::DeviceSize objectSize = sizeof(CullObject) * sorted.size();
+    auto staging = RenderCommand::getStagingPool().write(sorted.data(), objectSize);
+    m_objectBuffer.create(static_cast<uint32_t>(objectSize),
+                          vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+                          vk::MemoryPropertyFlagBits::eDeviceLocal);
+    m_objectBuffer.copyFrom(staging.buffer, staging.offset, objectSize);
+
+    m_frames.resize(frameUniforms.size(), FrameBuffers{Buffer(m_device, m_physicalDevice), Buffer(m_device, m_physicalDevice), {}});
+    for(auto& frame : m_frames)
+    {
+        frame.commands.create(static_cast<uint32_t>(sizeof(vk::DrawIndexedIndirectCommand) * m_objectCount),
+                              vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+        frame.counts.create(static_cast<uint32_t>(sizeof(uint32_t) * bucketCount),
+                            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                            vk::MemoryPropertyFlagBits::eDeviceLocal);
+    }
+
+    createDescriptorSets(frameUniforms);
+
+    m_enabled = true;
+    std::cout << "gpu culling: " << m_objectCount << " objects in " << bucketCount << " buckets\n";
+}
+
+void Renderer::Vulkan::GpuCuller::free()
+{
+    for(auto& frame : m_frames)
+    {
+        frame.commands.free();
+        frame.counts.free();
+    }
+    m_frames.clear();
+
+    if(m_enabled)
+        m_objectBuffer.free();
+
+    m_device.destroyPipeline(m_pipeline);
+    m_device.destroyPipelineLayout(m_pipelineLayout);
+    m_device.destroyDescriptorPool(m_descriptorPool);
+    m_device.destroyDescriptorSetLayout(m_descriptorSetLayout);
+    m_pipeline = nullptr;
+    m_pipelineLayout = nullptr;
+    m_descriptorPool = nullptr;
+    m_descriptorSetLayout = nullptr;
+
+    m_enabled = false;
+}
+
+void Renderer::Vulkan::GpuCuller::recordCull(vk::CommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if(!m_enabled)
+        return;
+
+    FrameBuffers& frame = m_frames[frameIndex];
+
+    //the frame slot's previous draws have finished (the frame fence was waited on), only the clear needs ordering
+    commandBuffer.fillBuffer(frame.counts.getHandle(), 0, VK_WHOLE_SIZE, 0);
+
+    vk::MemoryBarrier clearBarrier;
+    clearBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+    clearBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, clearBarrier, {}, {});
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+    commandBuffer.pushConstants(m_pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(uint32_t), &m_objectCount);
+    commandBuffer.dispatch((m_objectCount + s_workgroupSize - 1) / s_workgroupSize, 1, 1);
+
+    //commands and counts are read by the indirect draws
+    vk::MemoryBarrier cullBarrier;
+    cullBarrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+    cullBarrier.setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead);
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, {}, cullBarrier, {}, {});
+}
+
+void Renderer::Vulkan::GpuCuller::recordDraw(vk::CommandBuffer commandBuffer, uint32_t frameIndex, uint32_t bucket)
+{
+    uint32_t maxDraws = getBucketSize(bucket);
+    if(!m_enabled || maxDraws == 0)
+        return;
+
+    const FrameBuffers& frame = m_frames[frameIndex];
+    commandBuffer.drawIndexedIndirectCount(frame.commands.getHandle(), sizeof(vk::DrawIndexedIndirectCommand) * m_bucketOffsets[bucket],
+                                           frame.counts.getHandle(), sizeof(uint32_t) * bucket,
+                                           maxDraws, sizeof(vk::DrawIndexedIndirectCommand));
+}
+
+void Renderer::Vulkan::GpuCuller::createPipeline(const std::string& shaderFile, vk::PipelineCache pipelineCache)
+{
+    //throws if the spir-v is missing, init turns that into a fallback to cpu draws
+    Utils::FileSpan code = Utils::mapFile(shaderFile);
+
+    //0 frame ubo, 1 objects, 2 draw commands, 3 draw counts
+    std::array<vk::DescriptorSetLayoutBinding, 4> bindings;
+    for(uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].setBinding(i);
+        bindings[i].setDescriptorCount(1);
+        bindings[i].setDescriptorType(i == 0 ? vk::DescriptorType::eUniformBuffer : vk::DescriptorType::eStorageBuffer);
+        bindings[i].setStageFlags(vk::ShaderStageFlagBits::eCompute);
+    }
+
+    vk::DescriptorSetLayoutCreateInfo layoutInfo;
+    layoutInfo.setBindings(bindings);
+    m_descriptorSetLayout = m_device.createDescriptorSetLayout(layoutInfo);
+
+    //object count
+    vk::PushConstantRange pushConstantRange;
+    pushConstantRange.setStageFlags(vk::ShaderStageFlagBits::eCompute);
+    pushConstantRange.setOffset(0);
+    pushConstantRange.setSize(sizeof(uint32_t));
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+    pipelineLayoutInfo.setSetLayoutCount(1);
+    pipelineLayoutInfo.setPSetLayouts(&m_descriptorSetLayout);
+    pipelineLayoutInfo.setPushConstantRangeCount(1);
+    pipelineLayoutInfo.setPPushConstantRanges(&pushConstantRange);
+    m_pipelineLayout = m_device.createPipelineLayout(pipelineLayoutInfo);
+
+    vk::ShaderModuleCreateInfo moduleInfo;
+    moduleInfo.setCodeSize(code.size);
+    moduleInfo.setPCode(reinterpret_cast<const uint32_t*>(code.data));
+    vk::ShaderModule shaderModule = m_device.createShaderModule(moduleInfo);
+
+    vk::PipelineShaderStageCreateInfo stageInfo;
+    stageInfo.setStage(vk::ShaderStageFlagBits::eCompute);
+    stageInfo.setModule(shaderModule);
+    stageInfo.setPName("main");
+
+    vk::ComputePipelineCreateInfo pipelineInfo;
+    pipelineInfo.setStage(stageInfo);
+    pipelineInfo.setLayout(m_pipelineLayout);
+
+    vk::ResultValue<vk::Pipeline> pipeline = m_device.createComputePipeline(pipelineCache, pipelineInfo);
+    m_device.destroyShaderModule(shaderModule);
+
+    if(pipeline.result != vk::Result::eSuccess)
+        throw std::runtime_error("failed to create culling pipeline!");
+    m_pipeline = pipeline.value;
+}
+
+void Renderer::Vulkan::GpuCuller::createDescriptorSets(const std::vector<vk::DescriptorBufferInfo>& frameUniforms)
+{
+    uint32_t frameCount = static_cast<uint32_t>(frameUniforms.size());
+
+    std::array<vk::DescriptorPoolSize, 2> poolSizes;
+    poolSizes[0].setType(vk::DescriptorType::eUniformBuffer);
+    poolSizes[0].setDescriptorCount(frameCount);
+    poolSizes[1].setType(vk::DescriptorType::eStorageBuffer);
+    poolSizes[1].setDescriptorCount(frameCount * 3);
+
+    vk::DescriptorPoolCreateInfo poolInfo;
+    poolInfo.setPoolSizes(poolSizes);
+    poolInfo.setMaxSets(frameCount);
+    m_descriptorPool = m_device.createDescriptorPool(poolInfo);
+
+    std::vector<vk::DescriptorSetLayout> layouts(frameCount, m_descriptorSetLayout);
+    vk::DescriptorSetAllocateInfo allocInfo;
+    allocInfo.setDescriptorPool(m_descriptorPool);
+    allocInfo.setSetLayouts(layouts);
+    std::vector<vk::DescriptorSet> descriptorSets = m_device.allocateDescriptorSets(allocInfo);
+
+    for(uint32_t i = 0; i < frameCount; i++)
+    {
+        m_frames[i].descriptorSet = descriptorSets[i];
+
+        std::array<vk::DescriptorBufferInfo, 4> bufferInfos;
+        bufferInfos[0] = frameUniforms[i];
+        bufferInfos[1] = vk::DescriptorBufferInfo(m_objectBuffer.getHandle(), 0, VK_WHOLE_SIZE);
+        bufferInfos[2] = vk::DescriptorBufferInfo(m_frames[i].commands.getHandle(), 0, VK_WHOLE_SIZE);
+        bufferInfos[3] = vk::DescriptorBufferInfo(m_frames[i].counts.getHandle(), 0, VK_WHOLE_SIZE);
+
+        std::array<vk::WriteDescriptorSet, 4> descriptorWrites;
+        for(uint32_t binding = 0; binding < descriptorWrites.size(); binding++)
+        {
+            descriptorWrites[binding].setDstSet(descriptorSets[i]);
+            descriptorWrites[binding].setDstBinding(binding);
+            descriptorWrites[binding].setDstArrayElement(0);
+            descriptorWrites[binding].setDescriptorType(binding == 0 ? vk::DescriptorType::eUniformBuffer : vk::DescriptorType::eStorageBuffer);
+            descriptorWrites[binding].setDescriptorCount(1);
+            descriptorWrites[binding].setPBufferInfo(&bufferInfos[binding]);
+        }
+
+        m_device.updateDescriptorSets(descriptorWrites, {});
+    }
+}
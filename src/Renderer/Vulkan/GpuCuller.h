@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Buffer.h"
+
+//gpu driven culling: a compute pass tests every object's bounding sphere against the frustum and appends
+//a vk::DrawIndexedIndirectCommand for each visible one, which is then drawn with drawIndexedIndirectCount (vulkan 1.2).
+//objects are grouped into buckets (everything drawn with the same pipeline and descriptor set), every bucket owns
+//a contiguous range of commands and one counter, so the cpu records one draw per bucket however many objects there are
+namespace Renderer::Vulkan
+{
+	//matches CullObject in cull.comp (std430, 48 bytes)
+	struct CullObject
+	{
+		glm::vec4 sphere = glm::vec4(0.f); //xyz center, w radius, world space
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		int32_t vertexOffset = 0;
+		uint32_t firstInstance = 0;
+		uint32_t instanceCount = 1;
+		uint32_t bucket = 0;
+		uint32_t commandOffset = 0; //first command of the bucket, filled in by init
+		uint32_t padding = 0;
+	};
+
+	class GpuCuller
+	{
+	public:
+		static constexpr uint32_t s_workgroupSize = 64; //local_size_x in cull.comp
+
+		GpuCuller(vk::Device& device, vk::PhysicalDevice& physicalDevice);
+
+		//the drawIndirectCount and drawIndirectFirstInstance features have to be enabled on the device
+		static bool isSupported(vk::PhysicalDevice physicalDevice);
+
+		//frameUniforms is the UniformBufferObject of every frame in flight, the frustum is taken from it on the gpu
+		//stays disabled (every call is a no-op) if the compute shader can not be loaded
+		void init(const std::vector<CullObject>& objects, uint32_t bucketCount, const std::vector<vk::DescriptorBufferInfo>& frameUniforms,
+		          const std::string& shaderFile, vk::PipelineCache pipelineCache);
+		void free();
+
+		bool isEnabled() const { return m_enabled; }
+
+		//objects in the bucket, i.e. the most draws it can produce
+		uint32_t getBucketSize(uint32_t bucket) const { return m_bucketOffsets[bucket + 1] - m_bucketOffsets[bucket]; }
+		uint32_t getBucketCount() const { return static_cast<uint32_t>(m_bucketOffsets.size()) - 1; }
+
+		//resets the counters and culls, must be outside a render pass
+		void recordCull(vk::CommandBuffer commandBuffer, uint32_t frameIndex);
+		//the bucket's pipeline, descriptor set and vertex/index buffers have to be bound
+		void recordDraw(vk::CommandBuffer commandBuffer, uint32_t frameIndex, uint32_t bucket);
+	private:
+		void createPipeline(const std::string& shaderFile, vk::PipelineCache pipelineCache);
+		void createDescriptorSets(const std::vector<vk::DescriptorBufferInfo>& frameUniforms);
+
+		//draw commands and counters are written every frame, so each frame in flight has its own
+		struct FrameBuffers
+		{
+			Buffer commands;
+			Buffer counts;
+			vk::DescriptorSet descriptorSet;
+		};
+
+		Buffer m_objectBuffer;
+		std::vector<FrameBuffers> m_frames;
+		std::vector<uint32_t> m_bucketOffsets; //bucketCount + 1, bucket i owns commands [offsets[i], offsets[i + 1])
+		uint32_t m_objectCount = 0;
+		bool m_enabled = false;
+
+		vk::DescriptorSetLayout m_descriptorSetLayout;
+		vk::DescriptorPool m_descriptorPool;
+		vk::PipelineLayout m_pipelineLayout;
+		vk::Pipeline m_pipeline;
+
+		vk::Device& m_device;
+		vk::PhysicalDevice& m_physicalDevice;
+	};
+}
@@ -0,0 +1,163 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+Renderer::Vulkan::GpuProfiler::GpuProfiler(vk::Device& device, vk::PhysicalDevice& physicalDevice)
+    :m_device(device), m_physicalDevice(physicalDevice)
+{
+}
+
+bool Renderer::Vulkan::GpuProfiler::supportsTimestamps(vk::PhysicalDevice physicalDevice, uint32_t queueFamily)
+{
+    auto queueFamilies = physicalDevice.getQueueFamilyProperties();
+    return queueFamily < queueFamilies.size() && queueFamilies[queueFamily].timestampValidBits > 0
+        && physicalDevice.getProperties().limits.timestampPeriod > 0.f;
+}
+
+bool Renderer::Vulkan::GpuProfiler::supportsHostQueryReset(vk::PhysicalDevice physicalDevice)
+{
+    if(physicalDevice.getProperties().apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    return features.get<vk::PhysicalDeviceVulkan12Features>().hostQueryReset;
+}
+
+void Renderer::Vulkan::GpuProfiler::init(uint32_t queueFamily, uint32_t framesInFlight, uint32_t maxScopes)
+{
+    m_enabled = supportsTimestamps(m_physicalDevice, queueFamily);
+    if(!m_enabled)
+    {
+        std::cout << "gpu profiler disabled, queue family " << queueFamily << " has no timestamp support\n";
+        return;
+    }
+
+    m_timestampPeriod = m_physicalDevice.getProperties().limits.timestampPeriod;
+    m_maxScopes = maxScopes;
+
+    vk::QueryPoolCreateInfo poolInfo;
+    poolInfo.setQueryType(vk::QueryType::eTimestamp);
+    poolInfo.setQueryCount(m_maxScopes * 2);
+
+    m_frames.resize(framesInFlight);
+    for(auto& frame : m_frames)
+        frame.queryPool = m_device.createQueryPool(poolInfo);
+}
+
+void Renderer::Vulkan::GpuProfiler::free()
+{
+    for(auto& frame : m_frames)
+        m_device.destroyQueryPool(frame.queryPool);
+
+    m_frames.clear();
+    m_enabled = false;
+}
+
+void Renderer::Vulkan::GpuProfiler::beginRecording(vk::CommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if(!m_enabled)
+        return;
+
+    m_recordingFrame = frameIndex;
+    FrameQueries& frame = m_frames[m_recordingFrame];
+    frame.scopes.clear();
+
+    commandBuffer.resetQueryPool(frame.queryPool, 0, m_maxScopes * 2);
+}
+
+uint32_t Renderer::Vulkan::GpuProfiler::beginScope(vk::CommandBuffer commandBuffer, const std::string& name)
+{
+    if(!m_enabled)
+        return s_invalidScope;
+
+    FrameQueries& frame = m_frames[m_recordingFrame];
+    if(frame.scopes.size() >= m_maxScopes)
+        return s_invalidScope;
+
+    uint32_t scope = static_cast<uint32_t>(frame.scopes.size());
+    frame.scopes.push_back(name);
+
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool, scope * 2);
+    return scope;
+}
+
+void Renderer::Vulkan::GpuProfiler::endScope(vk::CommandBuffer commandBuffer, uint32_t scope)
+{
+    if(!m_enabled || scope == s_invalidScope)
+        return;
+
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_frames[m_recordingFrame].queryPool, scope * 2 + 1);
+}
+
+void Renderer::Vulkan::GpuProfiler::markSubmitted(uint32_t frameIndex)
+{
+    if(m_enabled)
+        m_frames[frameIndex].submitted = true;
+}
+
+void Renderer::Vulkan::GpuProfiler::collect(uint32_t frameIndex)
+{
+    if(!m_enabled || !m_frames[frameIndex].submitted)
+        return;
+
+    FrameQueries& frame = m_frames[frameIndex];
+    frame.submitted = false;
+
+    for(uint32_t scope = 0; scope < frame.scopes.size(); scope++)
+    {
+        double milliseconds = 0.0;
+        if(readScope(frame.queryPool, scope * 2, milliseconds))
+            addSample(frame.scopes[scope], milliseconds);
+    }
+}
+
+bool Renderer::Vulkan::GpuProfiler::readScope(vk::QueryPool queryPool, uint32_t firstQuery, double& milliseconds)
+{
+    if(!m_enabled)
+        return false;
+
+    //{timestamp, availability} for begin and end, no wait flag so this never stalls
+    std::array<uint64_t, 4> results{};
+    vk::Result result = m_device.getQueryPoolResults(queryPool, firstQuery, 2, sizeof(results), results.data(), sizeof(uint64_t) * 2,
+                                                     vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+
+    if((result != vk::Result::eSuccess && result != vk::Result::eNotReady) || results[1] == 0 || results[3] == 0)
+        return false;
+
+    uint64_t ticks = results[2] >= results[0] ? results[2] - results[0] : 0;
+    milliseconds = static_cast<double>(ticks) * m_timestampPeriod / 1000000.0;
+    return true;
+}
+
+void Renderer::Vulkan::GpuProfiler::addSample(const std::string& name, double milliseconds)
+{
+    ScopeStats& stats = m_stats[name];
+    stats.samples[stats.next] = milliseconds;
+    stats.next = (stats.next + 1) % s_historySize;
+    stats.count = std::min(stats.count + 1, s_historySize);
+}
+
+void Renderer::Vulkan::GpuProfiler::printStats()
+{
+    if(!m_enabled)
+        return;
+
+    std::cout << "gpu timings (last " << s_historySize << " samples):\n";
+    for(const auto& [name, stats] : m_stats)
+    {
+        if(stats.count == 0)
+            continue;
+
+        auto begin = stats.samples.begin();
+        auto end = begin + stats.count;
+
+        double min = *std::min_element(begin, end);
+        double max = *std::max_element(begin, end);
+        double sum = 0.0;
+        for(auto it = begin; it != end; ++it)
+            sum += *it;
+
+        std::cout << "    " << name << ": min " << min << "ms, avg " << sum / stats.count << "ms, max " << max << "ms\n";
+    }
+}
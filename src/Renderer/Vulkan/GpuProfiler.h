@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+//gpu timings from vkCmdWriteTimestamp pairs around named scopes
+//every frame in flight has its own query pool, results are read back once the frame slot comes around again
+//so nothing ever waits on the gpu. rolling min/avg/max over the last s_historySize samples per scope
+namespace Renderer::Vulkan
+{
+	class GpuProfiler
+	{
+	public:
+		static constexpr uint32_t s_historySize = 128;
+		static constexpr uint32_t s_invalidScope = UINT32_MAX;
+
+		GpuProfiler(vk::Device& device, vk::PhysicalDevice& physicalDevice);
+
+		//disabled (every call is a no-op) if queueFamily can not write timestamps
+		void init(uint32_t queueFamily, uint32_t framesInFlight, uint32_t maxScopes = 32);
+		void free();
+
+		bool isEnabled() const { return m_enabled; }
+		static bool supportsTimestamps(vk::PhysicalDevice physicalDevice, uint32_t queueFamily);
+		//vkResetQueryPool from the host, the only way to reset queries used on a transfer only queue
+		static bool supportsHostQueryReset(vk::PhysicalDevice physicalDevice);
+
+		//records the query reset, must be outside a render pass and before any scope of this frame
+		void beginRecording(vk::CommandBuffer commandBuffer, uint32_t frameIndex);
+		uint32_t beginScope(vk::CommandBuffer commandBuffer, const std::string& name);
+		void endScope(vk::CommandBuffer commandBuffer, uint32_t scope);
+
+		//the command buffer recorded for this frame slot was submitted (it may be a cached one)
+		void markSubmitted(uint32_t frameIndex);
+		//reads back what the frame slot submitted last time, the submission must have finished
+		void collect(uint32_t frameIndex);
+
+		//reads one begin/end pair written by someone else (e.g. uploads), false if not available
+		bool readScope(vk::QueryPool queryPool, uint32_t firstQuery, double& milliseconds);
+		void addSample(const std::string& name, double milliseconds);
+
+		void printStats();
+	private:
+		struct FrameQueries
+		{
+			vk::QueryPool queryPool;
+			std::vector<std::string> scopes;
+			bool submitted = false;
+		};
+
+		struct ScopeStats
+		{
+			std::array<double, s_historySize> samples{};
+			uint32_t count = 0;
+			uint32_t next = 0;
+		};
+
+		std::vector<FrameQueries> m_frames;
+		std::map<std::string, ScopeStats> m_stats;
+		uint32_t m_recordingFrame = 0;
+		uint32_t m_maxScopes = 0;
+		double m_timestampPeriod = 1.0; //nanoseconds per tick
+		bool m_enabled = false;
+
+		vk::Device& m_device;
+		vk::PhysicalDevice& m_physicalDevice;
+	};
+}
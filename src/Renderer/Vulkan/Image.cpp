@@ -33,12 +33,8 @@ void Renderer::Vulkan::Image::create(vk::Format format, vk::ImageTiling tiling,
 
     vk::MemoryRequirements memRequirements = m_device.getImageMemoryRequirements(m_image);
 
-    vk::MemoryAllocateInfo allocInfo;
-    allocInfo.setAllocationSize(memRequirements.size);
-    allocInfo.setMemoryTypeIndex(VulkanUtils::findMemoryType(memRequirements.memoryTypeBits, properties, m_physicalDevice));
-
-    m_imageMemory = m_device.allocateMemory(allocInfo);
-    m_device.bindImageMemory(m_image, m_imageMemory, 0);
+    m_allocation = MemoryAllocator::allocate(memRequirements, properties, tiling == vk::ImageTiling::eLinear);
+    m_device.bindImageMemory(m_image, m_allocation.memory, m_allocation.offset);
 
     createImageView(format, aspectFlags);
 }
@@ -130,11 +126,23 @@ void Renderer::Vulkan::Image::transitionImageLayout(vk::Format format, vk::Image
 }
 
 void Renderer::Vulkan::Image::copyFromBuffer(const Buffer& buffer, vk::ImageAspectFlagBits aspectFlag)
+{
+    copyFromBuffer(buffer.getHandle(), 0, aspectFlag);
+}
+
+void Renderer::Vulkan::Image::copyFromBuffer(vk::Buffer buffer, vk::DeviceSize bufferOffset, vk::ImageAspectFlagBits aspectFlag)
 {
     vk::CommandBuffer commandBuffer = RenderCommand::beginSingleTimeCommands();
 
+    recordCopyFromBuffer(commandBuffer, buffer, bufferOffset, aspectFlag);
+
+    RenderCommand::endSingleTimeCommands(commandBuffer);
+}
+
+void Renderer::Vulkan::Image::recordCopyFromBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize bufferOffset, vk::ImageAspectFlagBits aspectFlag)
+{
     std::array<vk::BufferImageCopy, 1> regions;
-    regions[0].setBufferOffset(0);
+    regions[0].setBufferOffset(bufferOffset);
     regions[0].setBufferRowLength(0);
     regions[0].setBufferImageHeight(0);
 
@@ -148,15 +156,26 @@ void Renderer::Vulkan::Image::copyFromBuffer(const Buffer& buffer, vk::ImageAspe
     regions[0].setImageOffset({0, 0, 0});
     regions[0].setImageExtent({m_width, m_height, 1});
 
-    commandBuffer.copyBufferToImage(buffer.getHandle(), m_image, vk::ImageLayout::eTransferDstOptimal, regions);
+    commandBuffer.copyBufferToImage(buffer, m_image, vk::ImageLayout::eTransferDstOptimal, regions);
+}
 
-    RenderCommand::endSingleTimeCommands(commandBuffer);
+void Renderer::Vulkan::Image::recordCopyToBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize bufferOffset, vk::ImageAspectFlagBits aspectFlag)
+{
+    vk::BufferImageCopy region;
+    region.setBufferOffset(bufferOffset);
+    region.setBufferRowLength(0);
+    region.setBufferImageHeight(0);
+    region.setImageSubresource({aspectFlag, 0, 0, 1});
+    region.setImageOffset({0, 0, 0});
+    region.setImageExtent({m_width, m_height, 1});
+
+    commandBuffer.copyImageToBuffer(m_image, vk::ImageLayout::eTransferSrcOptimal, buffer, region);
 }
 
 void Renderer::Vulkan::Image::free()
 {
     m_device.destroyImageView(m_imageView);
     m_device.destroyImage(m_image);
-    m_device.freeMemory(m_imageMemory);
+    MemoryAllocator::free(m_allocation);
     m_width = m_height = 0;
 }
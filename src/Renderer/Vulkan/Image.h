@@ -4,6 +4,7 @@
 
 #include "RenderCommand.h"
 #include "Buffer.h"
+#include "MemoryAllocator.h"
 
 namespace Renderer::Vulkan
 {
@@ -19,17 +20,23 @@ namespace Renderer::Vulkan
 		void transitionImageLayout(vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout);
 
 		void copyFromBuffer(const Buffer& buffer, vk::ImageAspectFlagBits aspectFlag);
+		void copyFromBuffer(vk::Buffer buffer, vk::DeviceSize bufferOffset, vk::ImageAspectFlagBits aspectFlag);
+		void recordCopyFromBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize bufferOffset, vk::ImageAspectFlagBits aspectFlag);
+		//the image has to be in transfer src layout, buffer is tightly packed
+		void recordCopyToBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize bufferOffset, vk::ImageAspectFlagBits aspectFlag);
 
 		void free();
 
 		vk::Image getHandle() { return m_image; }
 		vk::ImageView getImageView() { return m_imageView; };
+		uint32_t getWidth() const { return m_width; }
+		uint32_t getHeight() const { return m_height; }
 		void createImageView(vk::Format format, vk::ImageAspectFlags aspectFlags);
 	private:
 		uint32_t m_width, m_height = 0;
 
 		vk::Image m_image;
-		vk::DeviceMemory m_imageMemory;
+		Allocation m_allocation;
 		vk::ImageView m_imageView;
 
 		vk::Device& m_device;
@@ -0,0 +1,369 @@
+#include "MemoryAllocator.h"
+
+#include <iostream>
+#include <algorithm>
+
+#include "utils/VulkanUtils.h"
+
+vk::Device* Renderer::Vulkan::MemoryAllocator::m_sDevice = nullptr;
+vk::PhysicalDevice* Renderer::Vulkan::MemoryAllocator::m_sPhysicalDevice = nullptr;
+vk::PhysicalDeviceMemoryProperties Renderer::Vulkan::MemoryAllocator::m_sMemoryProperties;
+vk::DeviceSize Renderer::Vulkan::MemoryAllocator::m_sBufferImageGranularity = 1;
+uint32_t Renderer::Vulkan::MemoryAllocator::m_sDeviceMemoryCount = 0;
+std::vector<Renderer::Vulkan::MemoryAllocator::MemoryType> Renderer::Vulkan::MemoryAllocator::m_sMemoryTypes;
+std::mutex Renderer::Vulkan::MemoryAllocator::m_sMutex;
+
+static vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void Renderer::Vulkan::MemoryAllocator::init(vk::Device& device, vk::PhysicalDevice& physicalDevice)
+{
+    m_sDevice = &device;
+    m_sPhysicalDevice = &physicalDevice;
+    m_sMemoryProperties = physicalDevice.getMemoryProperties();
+    m_sBufferImageGranularity = physicalDevice.getProperties().limits.bufferImageGranularity;
+    m_sDeviceMemoryCount = 0;
+
+    m_sMemoryTypes.clear();
+    m_sMemoryTypes.resize(m_sMemoryProperties.memoryTypeCount);
+}
+
+void Renderer::Vulkan::MemoryAllocator::shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_sMutex);
+
+    //dedicated allocations are owned by their resources, only blocks are freed here
+    for(auto& memoryType : m_sMemoryTypes)
+    {
+        for(auto& block : memoryType.blocks)
+        {
+            if(block.memory)
+                m_sDevice->freeMemory(block.memory);
+        }
+    }
+
+    m_sMemoryTypes.clear();
+    m_sDeviceMemoryCount = 0;
+}
+
+Renderer::Vulkan::Allocation Renderer::Vulkan::MemoryAllocator::allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties, bool linear)
+{
+    std::lock_guard<std::mutex> lock(m_sMutex);
+
+    Allocation allocation;
+    allocation.memoryTypeIndex = VulkanUtils::findMemoryType(requirements.memoryTypeBits, properties, *m_sPhysicalDevice);
+    allocation.size = requirements.size;
+
+    //without a granularity restriction linear and optimal resources can share blocks
+    allocation.linear = m_sBufferImageGranularity > 1 ? linear : true;
+
+    MemoryType& memoryType = m_sMemoryTypes[allocation.memoryTypeIndex];
+    vk::DeviceSize alignment = std::max<vk::DeviceSize>(requirements.alignment, 1);
+    vk::DeviceSize slotSize = std::max(requirements.size, alignment);
+
+    if(requirements.size >= getBlockSize(allocation.memoryTypeIndex) / 2)
+    {
+        vk::MemoryAllocateInfo allocInfo;
+        allocInfo.setAllocationSize(requirements.size);
+        allocInfo.setMemoryTypeIndex(allocation.memoryTypeIndex);
+
+        allocation.memory = m_sDevice->allocateMemory(allocInfo);
+        allocation.offset = 0;
+        allocation.mapped = mapIfHostVisible(allocation.memoryTypeIndex, allocation.memory);
+        allocation.dedicated = true;
+
+        memoryType.dedicatedCount++;
+        memoryType.dedicatedBytes += requirements.size;
+        m_sDeviceMemoryCount++;
+    }
+    else if(slotSize <= (s_minSizeClass << (s_sizeClassCount - 1)))
+    {
+        //size classes are powers of two, so a slot aligned to its own size satisfies any smaller alignment
+        uint32_t sizeClass = 0;
+        while((s_minSizeClass << sizeClass) < slotSize)
+            sizeClass++;
+
+        vk::DeviceSize classSize = s_minSizeClass << sizeClass;
+        auto& freeSlots = memoryType.freeSlots[allocation.linear][sizeClass];
+
+        if(freeSlots.empty())
+        {
+            //carve a new chunk of slots out of a block
+            Allocation chunk;
+            if(!allocateFromBlocks(allocation.memoryTypeIndex, s_sizeClassChunk, classSize, allocation.linear, chunk))
+                throw std::runtime_error("failed to allocate size class chunk!");
+
+            for(vk::DeviceSize offset = s_sizeClassChunk; offset >= classSize; offset -= classSize)
+                freeSlots.push_back({chunk.blockIndex, chunk.offset + offset - classSize});
+        }
+
+        Slot slot = freeSlots.back();
+        freeSlots.pop_back();
+
+        Block& block = memoryType.blocks[slot.blockIndex];
+        allocation.memory = block.memory;
+        allocation.offset = slot.offset;
+        allocation.blockIndex = slot.blockIndex;
+        allocation.sizeClass = sizeClass;
+        allocation.fromSizeClass = true;
+        allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + slot.offset : nullptr;
+    }
+    else
+    {
+        if(!allocateFromBlocks(allocation.memoryTypeIndex, requirements.size, alignment, allocation.linear, allocation))
+            throw std::runtime_error("failed to sub-allocate device memory!");
+    }
+
+    memoryType.allocationCount++;
+    memoryType.usedBytes += requirements.size;
+    return allocation;
+}
+
+void Renderer::Vulkan::MemoryAllocator::free(Allocation& allocation)
+{
+    if(!allocation.memory)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_sMutex);
+
+    MemoryType& memoryType = m_sMemoryTypes[allocation.memoryTypeIndex];
+    memoryType.allocationCount--;
+    memoryType.usedBytes -= allocation.size;
+
+    if(allocation.dedicated)
+    {
+        m_sDevice->freeMemory(allocation.memory);
+        memoryType.dedicatedCount--;
+        memoryType.dedicatedBytes -= allocation.size;
+        m_sDeviceMemoryCount--;
+    }
+    else if(allocation.fromSizeClass)
+    {
+        memoryType.freeSlots[allocation.linear][allocation.sizeClass].push_back({allocation.blockIndex, allocation.offset});
+    }
+    else
+    {
+        Block& block = memoryType.blocks[allocation.blockIndex];
+        freeRange(block, allocation.offset, allocation.size);
+
+        //give empty blocks back to the driver, but keep the last one around to avoid thrashing
+        block.allocationCount--;
+        uint32_t liveBlocks = static_cast<uint32_t>(std::count_if(memoryType.blocks.begin(), memoryType.blocks.end(), [](const Block& b) { return static_cast<bool>(b.memory); }));
+        if(block.allocationCount == 0 && liveBlocks > 1)
+        {
+            m_sDevice->freeMemory(block.memory);
+            block = Block();
+            m_sDeviceMemoryCount--;
+        }
+    }
+
+    allocation = Allocation();
+}
+
+bool Renderer::Vulkan::MemoryAllocator::allocateFromBlocks(uint32_t typeIndex, vk::DeviceSize size, vk::DeviceSize alignment, bool linear, Allocation& allocation)
+{
+    MemoryType& memoryType = m_sMemoryTypes[typeIndex];
+
+    vk::DeviceSize offset = 0;
+    uint32_t blockIndex = 0;
+    bool found = false;
+
+    for(; blockIndex < memoryType.blocks.size(); blockIndex++)
+    {
+        Block& block = memoryType.blocks[blockIndex];
+        if(block.memory && block.linear == linear && allocateFromBlock(block, size, alignment, offset))
+        {
+            found = true;
+            break;
+        }
+    }
+
+    if(!found)
+    {
+        blockIndex = createBlock(typeIndex, linear);
+        if(!allocateFromBlock(memoryType.blocks[blockIndex], size, alignment, offset))
+            return false;
+    }
+
+    Block& block = memoryType.blocks[blockIndex];
+    block.allocationCount++;
+
+    allocation.memory = block.memory;
+    allocation.offset = offset;
+    allocation.size = size;
+    allocation.blockIndex = blockIndex;
+    allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr;
+    return true;
+}
+
+bool Renderer::Vulkan::MemoryAllocator::allocateFromBlock(Block& block, vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& offset)
+{
+    //first fit
+    for(size_t i = 0; i < block.freeRanges.size(); i++)
+    {
+        FreeRange range = block.freeRanges[i];
+        vk::DeviceSize alignedOffset = alignUp(range.offset, alignment);
+        vk::DeviceSize rangeEnd = range.offset + range.size;
+
+        if(alignedOffset + size > rangeEnd)
+            continue;
+
+        block.freeRanges.erase(block.freeRanges.begin() + i);
+
+        //keep the tail and the alignment padding as free ranges
+        if(alignedOffset + size < rangeEnd)
+            block.freeRanges.insert(block.freeRanges.begin() + i, {alignedOffset + size, rangeEnd - alignedOffset - size});
+        if(alignedOffset > range.offset)
+            block.freeRanges.insert(block.freeRanges.begin() + i, {range.offset, alignedOffset - range.offset});
+
+        offset = alignedOffset;
+        return true;
+    }
+
+    return false;
+}
+
+void Renderer::Vulkan::MemoryAllocator::freeRange(Block& block, vk::DeviceSize offset, vk::DeviceSize size)
+{
+    auto it = std::lower_bound(block.freeRanges.begin(), block.freeRanges.end(), offset,
+                               [](const FreeRange& range, vk::DeviceSize value) { return range.offset < value; });
+    it = block.freeRanges.insert(it, {offset, size});
+
+    //merge with next
+    auto next = it + 1;
+    if(next != block.freeRanges.end() && it->offset + it->size == next->offset)
+    {
+        it->size += next->size;
+        it = block.freeRanges.erase(next) - 1;
+    }
+
+    //merge with previous
+    if(it != block.freeRanges.begin())
+    {
+        auto prev = it - 1;
+        if(prev->offset + prev->size == it->offset)
+        {
+            prev->size += it->size;
+            block.freeRanges.erase(it);
+        }
+    }
+}
+
+uint32_t Renderer::Vulkan::MemoryAllocator::createBlock(uint32_t typeIndex, bool linear)
+{
+    MemoryType& memoryType = m_sMemoryTypes[typeIndex];
+
+    Block block;
+    block.size = getBlockSize(typeIndex);
+    block.linear = linear;
+    block.freeRanges.push_back({0, block.size});
+
+    vk::MemoryAllocateInfo allocInfo;
+    allocInfo.setAllocationSize(block.size);
+    allocInfo.setMemoryTypeIndex(typeIndex);
+
+    block.memory = m_sDevice->allocateMemory(allocInfo);
+    block.mapped = mapIfHostVisible(typeIndex, block.memory);
+    m_sDeviceMemoryCount++;
+
+    //reuse the slot of a previously freed block
+    for(uint32_t i = 0; i < memoryType.blocks.size(); i++)
+    {
+        if(!memoryType.blocks[i].memory)
+        {
+            memoryType.blocks[i] = block;
+            return i;
+        }
+    }
+
+    memoryType.blocks.push_back(block);
+    return static_cast<uint32_t>(memoryType.blocks.size() - 1);
+}
+
+vk::DeviceSize Renderer::Vulkan::MemoryAllocator::getBlockSize(uint32_t typeIndex)
+{
+    const vk::DeviceSize defaultBlockSize = 64ull * 1024 * 1024;
+    vk::DeviceSize heapSize = m_sMemoryProperties.memoryHeaps[m_sMemoryProperties.memoryTypes[typeIndex].heapIndex].size;
+
+    //small heaps (e.g. 256mb bar memory) get smaller blocks
+    if(heapSize < 1024ull * 1024 * 1024)
+        return std::min(defaultBlockSize, alignUp(heapSize / 8, s_sizeClassChunk));
+
+    return defaultBlockSize;
+}
+
+void* Renderer::Vulkan::MemoryAllocator::mapIfHostVisible(uint32_t typeIndex, vk::DeviceMemory memory)
+{
+    //mapping once up front as a memory object can only be mapped once at a time
+    if(m_sMemoryProperties.memoryTypes[typeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+        return m_sDevice->mapMemory(memory, 0, VK_WHOLE_SIZE);
+
+    return nullptr;
+}
+
+std::vector<Renderer::Vulkan::HeapStats> Renderer::Vulkan::MemoryAllocator::getHeapStats()
+{
+    std::lock_guard<std::mutex> lock(m_sMutex);
+
+    std::vector<HeapStats> stats(m_sMemoryProperties.memoryHeapCount);
+    for(uint32_t i = 0; i < m_sMemoryProperties.memoryHeapCount; i++)
+        stats[i].heapSize = m_sMemoryProperties.memoryHeaps[i].size;
+
+    for(uint32_t typeIndex = 0; typeIndex < m_sMemoryTypes.size(); typeIndex++)
+    {
+        const MemoryType& memoryType = m_sMemoryTypes[typeIndex];
+        HeapStats& heap = stats[m_sMemoryProperties.memoryTypes[typeIndex].heapIndex];
+
+        heap.dedicatedCount += memoryType.dedicatedCount;
+        heap.allocationCount += memoryType.allocationCount;
+        heap.reservedBytes += memoryType.dedicatedBytes;
+        heap.usedBytes += memoryType.usedBytes;
+
+        for(const auto& block : memoryType.blocks)
+        {
+            if(!block.memory)
+                continue;
+
+            heap.blockCount++;
+            heap.reservedBytes += block.size;
+
+            for(const auto& range : block.freeRanges)
+            {
+                heap.freeBytes += range.size;
+                heap.largestFreeRange = std::max(heap.largestFreeRange, range.size);
+            }
+        }
+
+        for(const auto& slotsPerKind : memoryType.freeSlots)
+        {
+            for(uint32_t sizeClass = 0; sizeClass < s_sizeClassCount; sizeClass++)
+                heap.freeBytes += slotsPerKind[sizeClass].size() * (s_minSizeClass << sizeClass);
+        }
+    }
+
+    return stats;
+}
+
+void Renderer::Vulkan::MemoryAllocator::printStats()
+{
+    auto stats = getHeapStats();
+    uint32_t maxAllocations = m_sPhysicalDevice->getProperties().limits.maxMemoryAllocationCount;
+
+    std::cout << "device memory: " << m_sDeviceMemoryCount << "/" << maxAllocations << " allocations\n";
+    for(size_t i = 0; i < stats.size(); i++)
+    {
+        const HeapStats& heap = stats[i];
+        if(heap.blockCount == 0 && heap.dedicatedCount == 0)
+            continue;
+
+        std::cout << "\theap " << i << ": "
+                  << heap.allocationCount << " resources, "
+                  << heap.blockCount << " blocks, "
+                  << heap.dedicatedCount << " dedicated, "
+                  << heap.usedBytes / 1024 << "kb used / "
+                  << heap.reservedBytes / 1024 << "kb reserved, "
+                  << "fragmentation " << heap.fragmentation() * 100.f << "%\n";
+    }
+}
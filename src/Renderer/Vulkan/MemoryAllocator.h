@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <vector>
+#include <mutex>
+
+//sub-allocates vk::DeviceMemory so that buffers/images do not each need their own allocation
+//small resources come from power of two size class slots, medium ones are first-fit inside big blocks
+//and anything close to the block size gets a dedicated allocation
+namespace Renderer::Vulkan
+{
+	//handed out by MemoryAllocator::allocate, bind with memory + offset
+	struct Allocation
+	{
+		vk::DeviceMemory memory;
+		vk::DeviceSize offset = 0;
+		vk::DeviceSize size = 0;
+		void* mapped = nullptr; //persistently mapped pointer to offset, only for host visible memory
+
+		uint32_t memoryTypeIndex = 0;
+		uint32_t blockIndex = 0;
+		uint32_t sizeClass = 0;
+		bool fromSizeClass = false;
+		bool dedicated = false;
+		bool linear = true;
+	};
+
+	struct HeapStats
+	{
+		vk::DeviceSize heapSize = 0;
+		uint32_t blockCount = 0;
+		uint32_t dedicatedCount = 0;
+		uint32_t allocationCount = 0;
+		vk::DeviceSize reservedBytes = 0; //memory actually allocated from the driver
+		vk::DeviceSize usedBytes = 0;     //memory handed out to resources
+		vk::DeviceSize freeBytes = 0;     //unused memory inside blocks
+		vk::DeviceSize largestFreeRange = 0;
+
+		//0 = all free memory is one contiguous range, close to 1 = free memory is scattered
+		float fragmentation() const { return freeBytes == 0 ? 0.f : 1.f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes); }
+	};
+
+	class MemoryAllocator
+	{
+	public:
+		static void init(vk::Device& device, vk::PhysicalDevice& physicalDevice);
+		static void shutdown();
+
+		//linear = buffers and linear tiled images, used to keep them apart from optimal images (bufferImageGranularity)
+		static Allocation allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties, bool linear);
+		static void free(Allocation& allocation);
+
+		static std::vector<HeapStats> getHeapStats();
+		static uint32_t getDeviceMemoryCount() { return m_sDeviceMemoryCount; }
+		static void printStats();
+	private:
+		struct FreeRange
+		{
+			vk::DeviceSize offset = 0;
+			vk::DeviceSize size = 0;
+		};
+
+		struct Block
+		{
+			vk::DeviceMemory memory;
+			vk::DeviceSize size = 0;
+			uint32_t allocationCount = 0;
+			std::vector<FreeRange> freeRanges; //sorted by offset
+			void* mapped = nullptr;
+			bool linear = true;
+		};
+
+		struct Slot
+		{
+			uint32_t blockIndex = 0;
+			vk::DeviceSize offset = 0;
+		};
+
+		static constexpr vk::DeviceSize s_minSizeClass = 256;
+		static constexpr uint32_t s_sizeClassCount = 9; //256 bytes -> 64 kb
+		static constexpr vk::DeviceSize s_sizeClassChunk = 256 * 1024;
+
+		struct MemoryType
+		{
+			std::vector<Block> blocks; //freed blocks keep their slot so block indices stay valid
+			std::array<std::vector<Slot>, s_sizeClassCount> freeSlots[2]; //[linear][size class]
+			uint32_t dedicatedCount = 0;
+			vk::DeviceSize dedicatedBytes = 0;
+			uint32_t allocationCount = 0;
+			vk::DeviceSize usedBytes = 0;
+		};
+
+		static bool allocateFromBlocks(uint32_t typeIndex, vk::DeviceSize size, vk::DeviceSize alignment, bool linear, Allocation& allocation);
+		static bool allocateFromBlock(Block& block, vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& offset);
+		static void freeRange(Block& block, vk::DeviceSize offset, vk::DeviceSize size);
+		static uint32_t createBlock(uint32_t typeIndex, bool linear);
+		static vk::DeviceSize getBlockSize(uint32_t typeIndex);
+		static void* mapIfHostVisible(uint32_t typeIndex, vk::DeviceMemory memory);
+
+		static vk::Device* m_sDevice;
+		static vk::PhysicalDevice* m_sPhysicalDevice;
+		static vk::PhysicalDeviceMemoryProperties m_sMemoryProperties;
+		static vk::DeviceSize m_sBufferImageGranularity;
+		static uint32_t m_sDeviceMemoryCount;
+		static std::vector<MemoryType> m_sMemoryTypes;
+		static std::mutex m_sMutex;
+	};
+}
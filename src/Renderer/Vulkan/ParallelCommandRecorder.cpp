@@ -0,0 +1,115 @@
+#include "ParallelCommandRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "utils/ThreadPool.h"
+
+Renderer::Vulkan::ParallelCommandRecorder::ParallelCommandRecorder(vk::Device& device)
+    :m_device(device)
+{
+}
+
+void Renderer::Vulkan::ParallelCommandRecorder::init(uint32_t queueFamily, uint32_t threadCount, uint32_t slotCount)
+{
+    m_queueFamily = queueFamily;
+    m_threadCount = std::max(1u, threadCount);
+    reserveSlots(slotCount);
+}
+
+void Renderer::Vulkan::ParallelCommandRecorder::reserveSlots(uint32_t slotCount)
+{
+    //pools are reset as a whole so command buffers do not need to be individually resettable
+    vk::CommandPoolCreateInfo poolInfo;
+    poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+    poolInfo.setQueueFamilyIndex(m_queueFamily);
+
+    size_t poolCount = static_cast<size_t>(slotCount) * m_threadCount;
+    while(m_pools.size() < poolCount)
+    {
+        WorkerPool pool;
+        pool.commandPool = m_device.createCommandPool(poolInfo);
+        m_pools.push_back(pool);
+    }
+}
+
+void Renderer::Vulkan::ParallelCommandRecorder::free()
+{
+    //destroying a pool frees its command buffers
+    for(auto& pool : m_pools)
+        m_device.destroyCommandPool(pool.commandPool);
+
+    m_pools.clear();
+    m_recorded.clear();
+}
+
+void Renderer::Vulkan::ParallelCommandRecorder::beginSlot(uint32_t slot)
+{
+    m_slot = slot;
+
+    for(uint32_t i = 0; i < m_threadCount; i++)
+    {
+        WorkerPool& pool = m_pools[m_slot * m_threadCount + i];
+        m_device.resetCommandPool(pool.commandPool);
+        pool.used = 0;
+    }
+}
+
+const std::vector<vk::CommandBuffer>& Renderer::Vulkan::ParallelCommandRecorder::record(uint32_t itemCount, uint32_t chunkSize,
+                                                                                           const vk::CommandBufferInheritanceInfo& inheritanceInfo,
+                                                                                           Utils::ThreadPool& threadPool, const RecordFunc& recordFunc)
+{
+    chunkSize = std::max(1u, chunkSize);
+    uint32_t chunkCount = (itemCount + chunkSize - 1) / chunkSize;
+    m_recorded.assign(chunkCount, vk::CommandBuffer());
+
+    //one job per pool, each job pulls chunks until none are left so a pool is never used by two threads
+    std::atomic<uint32_t> nextChunk = 0;
+    uint32_t jobCount = std::min(m_threadCount, chunkCount);
+    //only this call's jobs are waited for, the pool may be compiling pipelines at the same time
+    Utils::JobGroup jobs;
+
+    for(uint32_t job = 0; job < jobCount; job++)
+    {
+        WorkerPool& pool = m_pools[m_slot * m_threadCount + job];
+
+        threadPool.submit(jobs, [&, chunkSize, chunkCount, itemCount]
+        {
+            for(uint32_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+            {
+                vk::CommandBuffer commandBuffer = getCommandBuffer(pool);
+
+                vk::CommandBufferBeginInfo beginInfo;
+                //not one time submit, the primary executing it may be cached and submitted again
+                beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eRenderPassContinue);
+                beginInfo.setPInheritanceInfo(&inheritanceInfo);
+                commandBuffer.begin(beginInfo);
+
+                uint32_t begin = chunk * chunkSize;
+                recordFunc(commandBuffer, begin, std::min(begin + chunkSize, itemCount));
+
+                commandBuffer.end();
+                m_recorded[chunk] = commandBuffer;
+            }
+        });
+    }
+
+    jobs.wait();
+    return m_recorded;
+}
+
+vk::CommandBuffer Renderer::Vulkan::ParallelCommandRecorder::getCommandBuffer(WorkerPool& pool)
+{
+    //command buffers stay allocated across frames, resetting the pool makes them reusable
+    if(pool.used == pool.commandBuffers.size())
+    {
+        vk::CommandBufferAllocateInfo allocInfo;
+        allocInfo.setCommandPool(pool.commandPool);
+        allocInfo.setLevel(vk::CommandBufferLevel::eSecondary);
+        allocInfo.setCommandBufferCount(1);
+
+        pool.commandBuffers.push_back(m_device.allocateCommandBuffers(allocInfo)[0]);
+    }
+
+    return pool.commandBuffers[pool.used++];
+}
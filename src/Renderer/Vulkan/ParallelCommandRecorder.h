@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Utils
+{
+	class ThreadPool;
+}
+
+//records chunks of draw work into secondary command buffers on worker threads
+//every worker owns one command pool per slot, a slot's pools are reset as a whole in beginSlot.
+//a slot is whatever the caller records independently: a frame in flight, or a (frame, swapchain image) pair
+//for cached command buffers so re-recording one pair never invalidates the secondaries of another
+namespace Renderer::Vulkan
+{
+	class ParallelCommandRecorder
+	{
+	public:
+		//records items [begin, end) into an already begun secondary command buffer
+		using RecordFunc = std::function<void(vk::CommandBuffer commandBuffer, uint32_t begin, uint32_t end)>;
+
+		ParallelCommandRecorder(vk::Device& device);
+
+		void init(uint32_t queueFamily, uint32_t threadCount, uint32_t slotCount);
+		void free();
+
+		//adds pools for slots up to slotCount, existing slots and what was recorded with them stay untouched
+		void reserveSlots(uint32_t slotCount);
+
+		//everything previously recorded with this slot must have finished executing, it is invalidated
+		void beginSlot(uint32_t slot);
+
+		//splits itemCount into chunks of chunkSize and records them in parallel, blocks until done
+		//returns one secondary command buffer per chunk, in item order, ready for executeCommands
+		const std::vector<vk::CommandBuffer>& record(uint32_t itemCount, uint32_t chunkSize,
+		                                             const vk::CommandBufferInheritanceInfo& inheritanceInfo,
+		                                             Utils::ThreadPool& threadPool, const RecordFunc& recordFunc);
+
+		uint32_t getThreadCount() const { return m_threadCount; }
+	private:
+		struct WorkerPool
+		{
+			vk::CommandPool commandPool;
+			std::vector<vk::CommandBuffer> commandBuffers;
+			uint32_t used = 0;
+		};
+
+		vk::CommandBuffer getCommandBuffer(WorkerPool& pool);
+
+		//[slot * threadCount + thread]
+		std::vector<WorkerPool> m_pools;
+		std::vector<vk::CommandBuffer> m_recorded;
+		uint32_t m_queueFamily = 0;
+		uint32_t m_threadCount = 1;
+		uint32_t m_slot = 0;
+
+		vk::Device& m_device;
+	};
+}
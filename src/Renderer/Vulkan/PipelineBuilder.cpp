@@ -0,0 +1,246 @@
+#include "PipelineBuilder.h"
+
+#include <array>
+#include <functional>
+
+template<typename T>
+static void hashCombine(size_t& seed, const T& value)
+{
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+bool Renderer::Vulkan::PipelineState::operator==(const PipelineState& other) const
+{
+    return vertShader == other.vertShader
+        && fragShader == other.fragShader
+        && vertexBindings == other.vertexBindings
+        && vertexAttributes == other.vertexAttributes
+        && topology == other.topology
+        && polygonMode == other.polygonMode
+        && cullMode == other.cullMode
+        && frontFace == other.frontFace
+        && blendEnable == other.blendEnable
+        && depthTest == other.depthTest
+        && depthWrite == other.depthWrite
+        && depthCompareOp == other.depthCompareOp
+        && layout == other.layout
+        && renderPass == other.renderPass
+        && subpass == other.subpass
+        && colorFormat == other.colorFormat
+        && depthFormat == other.depthFormat;
+}
+
+size_t Renderer::Vulkan::PipelineState::hash() const
+{
+    size_t seed = 0;
+    hashCombine(seed, vertShader);
+    hashCombine(seed, fragShader);
+
+    for(const auto& binding : vertexBindings)
+    {
+        hashCombine(seed, binding.binding);
+        hashCombine(seed, binding.stride);
+        hashCombine(seed, binding.inputRate);
+    }
+
+    for(const auto& attribute : vertexAttributes)
+    {
+        hashCombine(seed, attribute.location);
+        hashCombine(seed, attribute.binding);
+        hashCombine(seed, attribute.format);
+        hashCombine(seed, attribute.offset);
+    }
+
+    hashCombine(seed, topology);
+    hashCombine(seed, polygonMode);
+    hashCombine(seed, static_cast<VkCullModeFlags>(cullMode));
+    hashCombine(seed, frontFace);
+    hashCombine(seed, blendEnable);
+    hashCombine(seed, depthTest);
+    hashCombine(seed, depthWrite);
+    hashCombine(seed, depthCompareOp);
+    hashCombine(seed, static_cast<VkPipelineLayout>(layout));
+    hashCombine(seed, static_cast<VkRenderPass>(renderPass));
+    hashCombine(seed, subpass);
+    hashCombine(seed, colorFormat);
+    hashCombine(seed, depthFormat);
+    return seed;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setShaders(const std::string& vertShader, const std::string& fragShader)
+{
+    m_state.vertShader = vertShader;
+    m_state.fragShader = fragShader;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setVertexLayout(const std::vector<vk::VertexInputBindingDescription>& bindings, const std::vector<vk::VertexInputAttributeDescription>& attributes)
+{
+    m_state.vertexBindings = bindings;
+    m_state.vertexAttributes = attributes;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setTopology(vk::PrimitiveTopology topology)
+{
+    m_state.topology = topology;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setRasterizer(vk::PolygonMode polygonMode, vk::CullModeFlags cullMode, vk::FrontFace frontFace)
+{
+    m_state.polygonMode = polygonMode;
+    m_state.cullMode = cullMode;
+    m_state.frontFace = frontFace;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setAlphaBlending(bool enable)
+{
+    m_state.blendEnable = enable;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setDepth(bool test, bool write, vk::CompareOp compareOp)
+{
+    m_state.depthTest = test;
+    m_state.depthWrite = write;
+    m_state.depthCompareOp = compareOp;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setLayout(vk::PipelineLayout layout)
+{
+    m_state.layout = layout;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setRenderPass(vk::RenderPass renderPass, uint32_t subpass)
+{
+    m_state.renderPass = renderPass;
+    m_state.subpass = subpass;
+    return *this;
+}
+
+Renderer::Vulkan::PipelineBuilder& Renderer::Vulkan::PipelineBuilder::setRenderingFormats(vk::Format colorFormat, vk::Format depthFormat)
+{
+    m_state.renderPass = nullptr;
+    m_state.subpass = 0;
+    m_state.colorFormat = colorFormat;
+    m_state.depthFormat = depthFormat;
+    return *this;
+}
+
+vk::ResultValue<vk::Pipeline> Renderer::Vulkan::PipelineBuilder::build(vk::Device device, vk::PipelineCache cache, const PipelineState& state,
+                                                                       vk::ShaderModule vertModule, vk::ShaderModule fragModule, const void* pNext)
+{
+    //shader stages
+    std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages;
+    shaderStages[0].setStage(vk::ShaderStageFlagBits::eVertex);
+    shaderStages[0].setModule(vertModule);
+    shaderStages[0].setPName("main");
+    shaderStages[1].setStage(vk::ShaderStageFlagBits::eFragment);
+    shaderStages[1].setModule(fragModule);
+    shaderStages[1].setPName("main");
+
+    //dynamic state
+    std::array<vk::DynamicState, 2> dynamicStates =
+    {
+        vk::DynamicState::eViewport,
+        vk::DynamicState::eScissor,
+    };
+
+    vk::PipelineDynamicStateCreateInfo dynamicState;
+    dynamicState.setDynamicStateCount(static_cast<uint32_t>(dynamicStates.size()));
+    dynamicState.setPDynamicStates(dynamicStates.data());
+
+    //vertex input info
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
+    vertexInputInfo.setVertexBindingDescriptionCount(static_cast<uint32_t>(state.vertexBindings.size()));
+    vertexInputInfo.setPVertexBindingDescriptions(state.vertexBindings.data());
+    vertexInputInfo.setVertexAttributeDescriptionCount(static_cast<uint32_t>(state.vertexAttributes.size()));
+    vertexInputInfo.setPVertexAttributeDescriptions(state.vertexAttributes.data());
+
+    //input assembly
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly;
+    inputAssembly.setTopology(state.topology);
+    inputAssembly.setPrimitiveRestartEnable(false);
+
+    //viewport and scissor are dynamic, only the count matters
+    vk::PipelineViewportStateCreateInfo viewportState;
+    viewportState.setViewportCount(1);
+    viewportState.setScissorCount(1);
+
+    //rasterizer
+    vk::PipelineRasterizationStateCreateInfo rasterizer;
+    rasterizer.setDepthClampEnable(false);
+    rasterizer.setRasterizerDiscardEnable(false);
+    rasterizer.setPolygonMode(state.polygonMode);
+    rasterizer.setLineWidth(1.f);
+    rasterizer.setCullMode(state.cullMode);
+    rasterizer.setFrontFace(state.frontFace);
+    rasterizer.setDepthBiasEnable(false);
+
+    vk::PipelineMultisampleStateCreateInfo multisampling;
+    multisampling.setSampleShadingEnable(false);
+    multisampling.setRasterizationSamples(vk::SampleCountFlagBits::e1);
+    multisampling.setMinSampleShading(1.f);
+
+    //options for alpha blending
+    vk::PipelineColorBlendAttachmentState colorBlendAttachment;
+    colorBlendAttachment.setColorWriteMask(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+    colorBlendAttachment.setBlendEnable(state.blendEnable);
+    colorBlendAttachment.setSrcColorBlendFactor(vk::BlendFactor::eSrcAlpha);
+    colorBlendAttachment.setDstColorBlendFactor(vk::BlendFactor::eOneMinusSrcAlpha);
+    colorBlendAttachment.setColorBlendOp(vk::BlendOp::eAdd);
+    colorBlendAttachment.setSrcAlphaBlendFactor(vk::BlendFactor::eOne);
+    colorBlendAttachment.setDstAlphaBlendFactor(vk::BlendFactor::eZero);
+    colorBlendAttachment.setAlphaBlendOp(vk::BlendOp::eAdd);
+
+    vk::PipelineColorBlendStateCreateInfo colorBlending;
+    colorBlending.setLogicOpEnable(false);
+    colorBlending.setLogicOp(vk::LogicOp::eCopy);
+    colorBlending.setAttachmentCount(1);
+    colorBlending.setPAttachments(&colorBlendAttachment);
+
+    vk::PipelineDepthStencilStateCreateInfo depthStencil;
+    depthStencil.setDepthTestEnable(state.depthTest);
+    depthStencil.setDepthWriteEnable(state.depthWrite);
+    depthStencil.setDepthCompareOp(state.depthCompareOp);
+    depthStencil.setDepthBoundsTestEnable(false);
+    depthStencil.setMinDepthBounds(0.f);
+    depthStencil.setMaxDepthBounds(1.f);
+    depthStencil.setStencilTestEnable(false);
+
+    //without a render pass the attachment formats come from the pNext chain
+    vk::PipelineRenderingCreateInfo renderingInfo;
+    if(!state.renderPass)
+    {
+        renderingInfo.setPNext(pNext);
+        renderingInfo.setColorAttachmentCount(1);
+        renderingInfo.setPColorAttachmentFormats(&state.colorFormat);
+        renderingInfo.setDepthAttachmentFormat(state.depthFormat);
+        pNext = &renderingInfo;
+    }
+
+    //create pipeline from all infos
+    vk::GraphicsPipelineCreateInfo pipelineInfo;
+    pipelineInfo.setPNext(pNext);
+    pipelineInfo.setStageCount(static_cast<uint32_t>(shaderStages.size()));
+    pipelineInfo.setPStages(shaderStages.data());
+    pipelineInfo.setPVertexInputState(&vertexInputInfo);
+    pipelineInfo.setPInputAssemblyState(&inputAssembly);
+    pipelineInfo.setPViewportState(&viewportState);
+    pipelineInfo.setPRasterizationState(&rasterizer);
+    pipelineInfo.setPMultisampleState(&multisampling);
+    pipelineInfo.setPDepthStencilState(&depthStencil);
+    pipelineInfo.setPColorBlendState(&colorBlending);
+    pipelineInfo.setPDynamicState(&dynamicState);
+    pipelineInfo.setLayout(state.layout);
+    pipelineInfo.setRenderPass(state.renderPass);
+    pipelineInfo.setSubpass(state.subpass);
+    pipelineInfo.setBasePipelineHandle(VK_NULL_HANDLE);
+    pipelineInfo.setBasePipelineIndex(-1);
+
+    return device.createGraphicsPipeline(cache, pipelineInfo);
+}
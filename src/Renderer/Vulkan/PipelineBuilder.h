@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <vector>
+
+//everything that goes into a graphics pipeline, used as the key of PipelineCache
+//viewport and scissor are always dynamic so they are not part of the state
+namespace Renderer::Vulkan
+{
+	struct PipelineState
+	{
+		std::string vertShader;
+		std::string fragShader;
+
+		std::vector<vk::VertexInputBindingDescription> vertexBindings;
+		std::vector<vk::VertexInputAttributeDescription> vertexAttributes;
+		vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+
+		vk::PolygonMode polygonMode = vk::PolygonMode::eFill;
+		vk::CullModeFlags cullMode = vk::CullModeFlagBits::eBack;
+		vk::FrontFace frontFace = vk::FrontFace::eCounterClockwise;
+
+		bool blendEnable = true;
+		bool depthTest = true;
+		bool depthWrite = true;
+		vk::CompareOp depthCompareOp = vk::CompareOp::eLess;
+
+		vk::PipelineLayout layout;
+		vk::RenderPass renderPass;
+		uint32_t subpass = 0;
+
+		//attachment formats, only used with dynamic rendering (no renderPass)
+		vk::Format colorFormat = vk::Format::eUndefined;
+		vk::Format depthFormat = vk::Format::eUndefined;
+
+		bool operator==(const PipelineState& other) const;
+		size_t hash() const;
+	};
+
+	struct PipelineStateHash
+	{
+		size_t operator()(const PipelineState& state) const { return state.hash(); }
+	};
+
+	class PipelineBuilder
+	{
+	public:
+		PipelineBuilder& setShaders(const std::string& vertShader, const std::string& fragShader);
+		PipelineBuilder& setVertexLayout(const std::vector<vk::VertexInputBindingDescription>& bindings, const std::vector<vk::VertexInputAttributeDescription>& attributes);
+		PipelineBuilder& setTopology(vk::PrimitiveTopology topology);
+		PipelineBuilder& setRasterizer(vk::PolygonMode polygonMode, vk::CullModeFlags cullMode, vk::FrontFace frontFace);
+		PipelineBuilder& setAlphaBlending(bool enable);
+		PipelineBuilder& setDepth(bool test, bool write, vk::CompareOp compareOp);
+		PipelineBuilder& setLayout(vk::PipelineLayout layout);
+		PipelineBuilder& setRenderPass(vk::RenderPass renderPass, uint32_t subpass = 0);
+		//dynamic rendering, clears the render pass
+		PipelineBuilder& setRenderingFormats(vk::Format colorFormat, vk::Format depthFormat);
+
+		const PipelineState& getState() const { return m_state; }
+
+		//creates the pipeline described by state, shader modules are owned by the caller
+		static vk::ResultValue<vk::Pipeline> build(vk::Device device, vk::PipelineCache cache, const PipelineState& state,
+		                                           vk::ShaderModule vertModule, vk::ShaderModule fragModule, const void* pNext = nullptr);
+	private:
+		PipelineState m_state;
+	};
+}
@@ -0,0 +1,205 @@
+#include "PipelineCache.h"
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+#include "PipelineDiskCache.h"
+#include "utils/MappedFile.h"
+#include "utils/ThreadPool.h"
+
+Renderer::Vulkan::PipelineCache::PipelineCache(vk::Device& device, PipelineDiskCache& diskCache)
+    :m_device(device), m_diskCache(diskCache)
+{
+}
+
+void Renderer::Vulkan::PipelineCache::init(bool creationFeedback)
+{
+    m_creationFeedback = creationFeedback;
+}
+
+void Renderer::Vulkan::PipelineCache::free()
+{
+    waitIdle();
+
+    for(auto& [state, entry] : m_pipelines)
+    {
+        if(entry.pipeline)
+            m_device.destroyPipeline(entry.pipeline);
+    }
+
+    for(auto& [filename, shaderModule] : m_shaderModules)
+        m_device.destroyShaderModule(shaderModule);
+
+    m_pipelines.clear();
+    m_shaderModules.clear();
+    m_compileTime = 0.0;
+}
+
+vk::Pipeline Renderer::Vulkan::PipelineCache::get(const PipelineState& state)
+{
+    m_requests++;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_pipelines.find(state);
+    if(it == m_pipelines.end())
+    {
+        //claim the entry so nobody else compiles the same state, then compile without holding the lock
+        m_pipelines.emplace(state, Entry());
+        m_pending++;
+        lock.unlock();
+
+        vk::Pipeline pipeline;
+        try
+        {
+            pipeline = createPipeline(state);
+        }
+        catch(...)
+        {
+            finishPipeline(state, nullptr);
+            throw;
+        }
+
+        finishPipeline(state, pipeline);
+        return pipeline;
+    }
+
+    //being compiled on another thread, wait for it
+    Entry& entry = it->second;
+    m_pipelineReady.wait(lock, [&entry]{ return entry.ready; });
+
+    if(!entry.pipeline)
+        throw std::runtime_error("failed to create graphics pipeline");
+
+    return entry.pipeline;
+}
+
+vk::Pipeline Renderer::Vulkan::PipelineCache::tryGet(const PipelineState& state, vk::Pipeline placeholder)
+{
+    m_requests++;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_pipelines.find(state);
+    if(it == m_pipelines.end() || !it->second.ready || !it->second.pipeline)
+        return placeholder;
+
+    return it->second.pipeline;
+}
+
+uint32_t Renderer::Vulkan::PipelineCache::compileAsync(const std::vector<PipelineState>& states, Utils::ThreadPool& threadPool)
+{
+    uint32_t queued = 0;
+
+    for(const auto& state : states)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(!m_pipelines.emplace(state, Entry()).second)
+                continue;
+            m_pending++;
+        }
+
+        threadPool.submit([this, state]
+        {
+            vk::Pipeline pipeline;
+            try
+            {
+                pipeline = createPipeline(state);
+            }
+            catch(const std::exception& e)
+            {
+                std::cout << "async pipeline compilation failed: " << e.what() << "\n";
+            }
+
+            finishPipeline(state, pipeline);
+        });
+        queued++;
+    }
+
+    return queued;
+}
+
+void Renderer::Vulkan::PipelineCache::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pipelineReady.wait(lock, [this]{ return m_pending == 0; });
+}
+
+vk::ShaderModule Renderer::Vulkan::PipelineCache::getShaderModule(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+    auto it = m_shaderModules.find(filename);
+    if(it != m_shaderModules.end())
+        return it->second;
+
+    //the mapping is page aligned so the spir-v can be handed to the driver without a copy
+    Utils::FileSpan code = Utils::mapFile(filename);
+
+    vk::ShaderModuleCreateInfo createInfo{};
+    createInfo.setCodeSize(code.size);
+    createInfo.setPCode(reinterpret_cast<const uint32_t*>(code.data));
+
+    vk::ShaderModule shaderModule = m_device.createShaderModule(createInfo);
+    m_shaderModules.emplace(filename, shaderModule);
+    return shaderModule;
+}
+
+size_t Renderer::Vulkan::PipelineCache::getPipelineCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pipelines.size();
+}
+
+double Renderer::Vulkan::PipelineCache::getCompileTime()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_compileTime;
+}
+
+vk::Pipeline Renderer::Vulkan::PipelineCache::createPipeline(const PipelineState& state)
+{
+    vk::ShaderModule vertModule = getShaderModule(state.vertShader);
+    vk::ShaderModule fragModule = getShaderModule(state.fragShader);
+
+    //ask the driver whether the pipeline came out of the disk cache
+    vk::PipelineCreationFeedback pipelineFeedback;
+    std::array<vk::PipelineCreationFeedback, 2> stageFeedbacks;
+    vk::PipelineCreationFeedbackCreateInfo feedbackInfo;
+    feedbackInfo.setPPipelineCreationFeedback(&pipelineFeedback);
+    feedbackInfo.setPipelineStageCreationFeedbackCount(static_cast<uint32_t>(stageFeedbacks.size()));
+    feedbackInfo.setPPipelineStageCreationFeedbacks(stageFeedbacks.data());
+
+    //vk::PipelineCache is internally synchronized, worker threads can share the disk cache handle
+    auto start = std::chrono::high_resolution_clock::now();
+    auto result = PipelineBuilder::build(m_device, m_diskCache.getHandle(), state, vertModule, fragModule,
+                                         m_creationFeedback ? &feedbackInfo : nullptr);
+    double creationTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    if(result.result != vk::Result::eSuccess)
+        throw std::runtime_error("failed to create graphics pipeline");
+
+    bool feedbackValid = m_creationFeedback && (pipelineFeedback.flags & vk::PipelineCreationFeedbackFlagBits::eValid);
+    bool cacheHit = feedbackValid && (pipelineFeedback.flags & vk::PipelineCreationFeedbackFlagBits::eApplicationPipelineCacheHit);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_diskCache.recordPipeline(creationTime, feedbackValid, cacheHit);
+        m_compileTime += creationTime;
+    }
+
+    return result.value;
+}
+
+void Renderer::Vulkan::PipelineCache::finishPipeline(const PipelineState& state, vk::Pipeline pipeline)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_pipelines[state];
+        entry.pipeline = pipeline;
+        entry.ready = true;
+        m_pending--;
+    }
+    m_pipelineReady.notify_all();
+}
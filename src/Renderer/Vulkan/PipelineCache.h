@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PipelineBuilder.h"
+
+namespace Utils
+{
+	class ThreadPool;
+}
+
+//maps a PipelineState to a vk::Pipeline so identical requests share one pipeline
+//shader modules are cached by filename and live as long as the cache
+//all public functions are thread safe, pipelines can be compiled on a ThreadPool with compileAsync
+namespace Renderer::Vulkan
+{
+	class PipelineDiskCache;
+
+	class PipelineCache
+	{
+	public:
+		PipelineCache(vk::Device& device, PipelineDiskCache& diskCache);
+
+		//creationFeedback: VK_EXT_pipeline_creation_feedback is enabled on the device
+		void init(bool creationFeedback);
+		void free();
+
+		//blocks if the pipeline is still being compiled on a worker thread
+		vk::Pipeline get(const PipelineState& state);
+		//never blocks, returns placeholder while the pipeline is not ready (or was never requested)
+		vk::Pipeline tryGet(const PipelineState& state, vk::Pipeline placeholder);
+
+		//queues every state that is not in the cache yet, returns how many were queued
+		uint32_t compileAsync(const std::vector<PipelineState>& states, Utils::ThreadPool& threadPool);
+		void waitIdle();
+
+		vk::ShaderModule getShaderModule(const std::string& filename);
+
+		size_t getPipelineCount();
+		uint32_t getRequestCount() const { return m_requests; }
+		//sum of the time spent inside vkCreateGraphicsPipelines, across all threads
+		double getCompileTime();
+	private:
+		struct Entry
+		{
+			vk::Pipeline pipeline;
+			bool ready = false;
+		};
+
+		vk::Pipeline createPipeline(const PipelineState& state);
+		void finishPipeline(const PipelineState& state, vk::Pipeline pipeline);
+
+		std::unordered_map<PipelineState, Entry, PipelineStateHash> m_pipelines;
+		std::unordered_map<std::string, vk::ShaderModule> m_shaderModules;
+		std::mutex m_mutex;
+		std::mutex m_shaderMutex;
+		std::condition_variable m_pipelineReady;
+		uint32_t m_pending = 0;
+
+		bool m_creationFeedback = false;
+		std::atomic<uint32_t> m_requests = 0;
+		double m_compileTime = 0.0;
+
+		vk::Device& m_device;
+		PipelineDiskCache& m_diskCache;
+	};
+}
@@ -0,0 +1,133 @@
+#include "PipelineDiskCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+#include "utils/Utils.h"
+
+Renderer::Vulkan::PipelineDiskCache::PipelineDiskCache(vk::Device& device, vk::PhysicalDevice& physicalDevice)
+    :m_device(device), m_physicalDevice(physicalDevice)
+{
+}
+
+void Renderer::Vulkan::PipelineDiskCache::load(const std::string& filename)
+{
+    m_filename = filename;
+    m_warm = false;
+
+    std::vector<char> data;
+    if(std::filesystem::exists(filename))
+    {
+        data = Utils::readFile(filename);
+
+        //a cache from another driver/gpu is useless, and some drivers do not handle bad data well
+        if(!isHeaderValid(data))
+        {
+            std::cout << "pipeline cache " << filename << " does not match this device, starting cold\n";
+            data.clear();
+        }
+    }
+
+    vk::PipelineCacheCreateInfo createInfo;
+    createInfo.setInitialDataSize(data.size());
+    createInfo.setPInitialData(data.empty() ? nullptr : data.data());
+
+    m_cache = m_device.createPipelineCache(createInfo);
+    m_warm = !data.empty();
+}
+
+void Renderer::Vulkan::PipelineDiskCache::save()
+{
+    if(!m_cache || m_filename.empty())
+        return;
+
+    std::vector<uint8_t> data = m_device.getPipelineCacheData(m_cache);
+
+    //write to a temp file and rename it over the old one so a crash never leaves a half written cache
+    std::string tempFilename = m_filename + ".tmp";
+    {
+        std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+        if(!file.is_open())
+        {
+            std::cout << "failed to write pipeline cache!\n";
+            return;
+        }
+
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if(!file.good())
+        {
+            std::cout << "failed to write pipeline cache!\n";
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempFilename, m_filename, error);
+    if(error)
+        std::cout << "failed to replace pipeline cache: " << error.message() << "\n";
+}
+
+void Renderer::Vulkan::PipelineDiskCache::free()
+{
+    if(m_cache)
+        m_device.destroyPipelineCache(m_cache);
+    m_cache = nullptr;
+}
+
+void Renderer::Vulkan::PipelineDiskCache::recordPipeline(double milliseconds, bool feedbackValid, bool cacheHit)
+{
+    m_pipelineCount++;
+    m_totalTime += milliseconds;
+
+    if(!feedbackValid)
+        return;
+
+    if(cacheHit)
+    {
+        m_hits++;
+        m_hitTime += milliseconds;
+    }
+    else
+    {
+        m_misses++;
+        m_missTime += milliseconds;
+    }
+}
+
+void Renderer::Vulkan::PipelineDiskCache::printStats()
+{
+    std::cout << "pipeline cache (" << (m_warm ? "warm" : "cold") << "): "
+              << m_pipelineCount << " pipelines in " << m_totalTime << "ms";
+
+    if(m_hits + m_misses > 0)
+    {
+        std::cout << ", " << m_hits << " hits (" << m_hitTime << "ms), "
+                  << m_misses << " misses (" << m_missTime << "ms)";
+    }
+
+    std::cout << "\n";
+}
+
+bool Renderer::Vulkan::PipelineDiskCache::isHeaderValid(const std::vector<char>& data)
+{
+    //VkPipelineCacheHeaderVersionOne: headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID
+    const size_t headerSize = 16 + VK_UUID_SIZE;
+    if(data.size() < headerSize)
+        return false;
+
+    uint32_t header[4];
+    memcpy(header, data.data(), sizeof(header));
+
+    vk::PhysicalDeviceProperties properties = m_physicalDevice.getProperties();
+
+    if(header[0] < headerSize || header[0] > data.size())
+        return false;
+    if(header[1] != static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne))
+        return false;
+    if(header[2] != properties.vendorID || header[3] != properties.deviceID)
+        return false;
+
+    return memcmp(data.data() + 16, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <vector>
+
+//vk::PipelineCache that is loaded from disk at startup and written back at shutdown
+//the file is only used if its header matches this device (vendor, device id and pipelineCacheUUID)
+namespace Renderer::Vulkan
+{
+	class PipelineDiskCache
+	{
+	public:
+		PipelineDiskCache(vk::Device& device, vk::PhysicalDevice& physicalDevice);
+
+		void load(const std::string& filename);
+		void save();
+		void free();
+
+		vk::PipelineCache getHandle() const { return m_cache; }
+		bool isWarm() const { return m_warm; }
+
+		//cacheHit is only meaningful when feedbackValid (VK_EXT_pipeline_creation_feedback)
+		void recordPipeline(double milliseconds, bool feedbackValid, bool cacheHit);
+		void printStats();
+	private:
+		bool isHeaderValid(const std::vector<char>& data);
+
+		vk::PipelineCache m_cache;
+		std::string m_filename;
+		bool m_warm = false;
+
+		uint32_t m_pipelineCount = 0;
+		uint32_t m_hits = 0;
+		uint32_t m_misses = 0;
+		double m_hitTime = 0.0;
+		double m_missTime = 0.0;
+		double m_totalTime = 0.0;
+
+		vk::Device& m_device;
+		vk::PhysicalDevice& m_physicalDevice;
+	};
+}
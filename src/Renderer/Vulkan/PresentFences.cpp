@@ -0,0 +1,155 @@
+#include "PresentFences.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "utils/VulkanUtils.h"
+
+Renderer::Vulkan::PresentFences::PresentFences(vk::Device& device)
+    :m_device(device)
+{
+}
+
+bool Renderer::Vulkan::PresentFences::addInstanceExtensions(std::vector<const char*>& extensions)
+{
+    const char* required[] = {VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME, VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME};
+
+    auto available = vk::enumerateInstanceExtensionProperties();
+    for(const char* name : required)
+    {
+        bool found = std::any_of(available.begin(), available.end(), [name](const vk::ExtensionProperties& extension)
+        {
+            return std::strcmp(extension.extensionName, name) == 0;
+        });
+        if(!found)
+            return false;
+    }
+
+    extensions.insert(extensions.end(), std::begin(required), std::end(required));
+    return true;
+}
+
+bool Renderer::Vulkan::PresentFences::isSupported(vk::PhysicalDevice physicalDevice)
+{
+    std::vector<const char*> extensions;
+    addDeviceExtensions(extensions);
+    if(!VulkanUtils::checkDeviceExtensionSupport(physicalDevice, extensions))
+        return false;
+
+    auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>();
+    return features.get<vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>().swapchainMaintenance1;
+}
+
+void Renderer::Vulkan::PresentFences::addDeviceExtensions(std::vector<const char*>& extensions)
+{
+    extensions.push_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+}
+
+void Renderer::Vulkan::PresentFences::init(bool enabled, uint32_t retireFrames)
+{
+    m_enabled = enabled;
+    m_retireFrames = retireFrames;
+}
+
+void Renderer::Vulkan::PresentFences::free()
+{
+    for(auto& present : m_pending)
+        m_device.destroyFence(present.fence);
+    for(auto fence : m_freeFences)
+        m_device.destroyFence(fence);
+    for(auto& retired : m_retired)
+        m_device.destroySwapchainKHR(retired.swapChain);
+
+    m_pending.clear();
+    m_freeFences.clear();
+    m_retired.clear();
+}
+
+const vk::SwapchainPresentFenceInfoEXT* Renderer::Vulkan::PresentFences::getPresentFence(vk::SwapchainKHR swapChain, const void* pNext)
+{
+    if(!m_enabled)
+        return nullptr;
+
+    if(m_freeFences.empty())
+        m_freeFences.push_back(m_device.createFence(vk::FenceCreateInfo()));
+
+    m_fence = m_freeFences.back();
+    m_freeFences.pop_back();
+    m_pending.push_back({swapChain, m_fence});
+
+    m_fenceInfo.setSwapchainCount(1);
+    m_fenceInfo.setPFences(&m_fence);
+    m_fenceInfo.setPNext(pNext);
+    return &m_fenceInfo;
+}
+
+void Renderer::Vulkan::PresentFences::destroyAfterPresents(vk::SwapchainKHR swapChain)
+{
+    m_retired.push_back({swapChain, m_updateCount, m_presentCount});
+}
+
+void Renderer::Vulkan::PresentFences::update()
+{
+    m_updateCount++;
+
+    //presents can finish out of order, so every pending fence is polled
+    for(size_t i = 0; i < m_pending.size();)
+    {
+        if(m_device.getFenceStatus(m_pending[i].fence) != vk::Result::eSuccess)
+        {
+            i++;
+            continue;
+        }
+
+        m_device.resetFences(m_pending[i].fence);
+        m_freeFences.push_back(m_pending[i].fence);
+        m_pending[i] = m_pending.back();
+        m_pending.pop_back();
+    }
+
+    auto isPresenting = [this](vk::SwapchainKHR swapChain)
+    {
+        return std::any_of(m_pending.begin(), m_pending.end(), [swapChain](const PendingPresent& present){ return present.swapChain == swapChain; });
+    };
+
+    for(size_t i = 0; i < m_retired.size();)
+    {
+        const RetiredSwapChain& retired = m_retired[i];
+        uint64_t age = m_updateCount - retired.retiredUpdate;
+
+        //without fences nothing says when the presentation engine let go of the images, a few frames and a
+        //successful present to the newer swapchain is as close as it gets
+        bool done = m_enabled ? !isPresenting(retired.swapChain)
+                              : age >= m_retireFrames && m_presentCount > retired.retiredPresent;
+        bool overdue = m_enabled && age >= m_maxRetiredFrames;
+        if(!done && !overdue)
+        {
+            i++;
+            continue;
+        }
+
+        if(!done)
+            destroyPresents(retired.swapChain);
+        m_device.destroySwapchainKHR(retired.swapChain);
+        m_retired[i] = m_retired.back();
+        m_retired.pop_back();
+    }
+}
+
+void Renderer::Vulkan::PresentFences::destroyPresents(vk::SwapchainKHR swapChain)
+{
+    //long overdue, so these presents were never queued and their fences will not be signalled.
+    //they can not be reset and reused either, the fences are destroyed with the swapchain
+    for(size_t i = 0; i < m_pending.size();)
+    {
+        if(m_pending[i].swapChain != swapChain)
+        {
+            i++;
+            continue;
+        }
+
+        m_device.destroyFence(m_pending[i].fence);
+        m_pending[i] = m_pending.back();
+        m_pending.pop_back();
+    }
+}
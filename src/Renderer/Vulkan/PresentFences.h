@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+//VK_EXT_swapchain_maintenance1 present fences: every present signals a fence once the presentation engine is done
+//with it, so a retired swapchain can be destroyed as soon as its own presents finished instead of idling the queue.
+//without the extension retired swapchains are kept for a few frames and destroyed after a later present succeeded
+namespace Renderer::Vulkan
+{
+	class PresentFences
+	{
+	public:
+		PresentFences(vk::Device& device);
+
+		//VK_EXT_surface_maintenance1 and what it depends on, appended only if the instance has all of them
+		static bool addInstanceExtensions(std::vector<const char*>& extensions);
+		//needs the instance extensions above, VK_EXT_swapchain_maintenance1 and its feature
+		static bool isSupported(vk::PhysicalDevice physicalDevice);
+		static void addDeviceExtensions(std::vector<const char*>& extensions);
+
+		//enabled: the device was created with the swapchainMaintenance1 feature
+		//retireFrames: how many updates a retired swapchain is kept for when there are no present fences
+		void init(bool enabled, uint32_t retireFrames);
+		//device must be idle, retired swapchains that are left are destroyed
+		void free();
+
+		bool isEnabled() const { return m_enabled; }
+
+		//chain the returned info into vk::PresentInfoKHR for one present to swapChain, pNext is chained behind it.
+		//nullptr when disabled
+		const vk::SwapchainPresentFenceInfoEXT* getPresentFence(vk::SwapchainKHR swapChain, const void* pNext);
+
+		//nothing will be presented to swapChain anymore, it is destroyed by update once its presents are done
+		void destroyAfterPresents(vk::SwapchainKHR swapChain);
+		//a present was queued (success or suboptimal), without present fences retired swapchains wait for one
+		void markPresented() { m_presentCount++; }
+		//once per frame: recycles the fences of finished presents and destroys retired swapchains with nothing left in flight
+		void update();
+	private:
+		struct PendingPresent
+		{
+			vk::SwapchainKHR swapChain;
+			vk::Fence fence;
+		};
+
+		struct RetiredSwapChain
+		{
+			vk::SwapchainKHR swapChain;
+			uint64_t retiredUpdate = 0;
+			uint64_t retiredPresent = 0;
+		};
+
+		void destroyPresents(vk::SwapchainKHR swapChain);
+
+		bool m_enabled = false;
+		std::vector<PendingPresent> m_pending;
+		std::vector<vk::Fence> m_freeFences;
+		std::vector<RetiredSwapChain> m_retired;
+		uint64_t m_updateCount = 0;
+		uint64_t m_presentCount = 0;
+		uint32_t m_retireFrames = 0;
+		//a present that failed (out of date) may never signal its fence, its swapchain is destroyed anyway after this many updates
+		const uint32_t m_maxRetiredFrames = 60;
+
+		vk::Fence m_fence;
+		vk::SwapchainPresentFenceInfoEXT m_fenceInfo;
+
+		vk::Device& m_device;
+	};
+}
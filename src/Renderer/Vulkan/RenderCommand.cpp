@@ -1,17 +1,50 @@
 #include "RenderCommand.h"
 
+#include "StagingPool.h"
+
 vk::Device* Renderer::Vulkan::RenderCommand::m_sDevice = nullptr;
 vk::CommandPool* Renderer::Vulkan::RenderCommand::m_sCommandPool = nullptr;
 vk::Queue* Renderer::Vulkan::RenderCommand::m_sGraphicsQueue = nullptr;
+Renderer::Vulkan::StagingPool* Renderer::Vulkan::RenderCommand::m_sStagingPool = nullptr;
+
+vk::CommandBuffer Renderer::Vulkan::RenderCommand::m_sBatchCommandBuffer;
+uint32_t Renderer::Vulkan::RenderCommand::m_sBatchDepth = 0;
+uint32_t Renderer::Vulkan::RenderCommand::m_sBatchedCommands = 0;
+std::vector<std::function<void()>> Renderer::Vulkan::RenderCommand::m_sDeferred;
 
-void Renderer::Vulkan::RenderCommand::initRenderCommands(vk::Device& device, vk::CommandPool& commandPool, vk::Queue& graphicsQueue)
+void Renderer::Vulkan::RenderCommand::initRenderCommands(vk::Device& device, vk::CommandPool& commandPool, vk::Queue& graphicsQueue, StagingPool& stagingPool)
 {
     m_sDevice = &device;
     m_sCommandPool = &commandPool;
     m_sGraphicsQueue = &graphicsQueue;
+    m_sStagingPool = &stagingPool;
 }
 
 vk::CommandBuffer Renderer::Vulkan::RenderCommand::beginSingleTimeCommands()
+{
+    if(isBatching())
+    {
+        //first command of the batch creates the shared command buffer
+        if(!m_sBatchCommandBuffer)
+            m_sBatchCommandBuffer = allocateAndBegin();
+
+        m_sBatchedCommands++;
+        return m_sBatchCommandBuffer;
+    }
+
+    return allocateAndBegin();
+}
+
+void Renderer::Vulkan::RenderCommand::endSingleTimeCommands(vk::CommandBuffer commandBuffer)
+{
+    //batched commands are submitted together in endBatch
+    if(isBatching() && commandBuffer == m_sBatchCommandBuffer)
+        return;
+
+    submitAndWait(commandBuffer);
+}
+
+vk::CommandBuffer Renderer::Vulkan::RenderCommand::allocateAndBegin()
 {
     vk::CommandBufferAllocateInfo allocInfo{};
     allocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
@@ -28,7 +61,7 @@ vk::CommandBuffer Renderer::Vulkan::RenderCommand::beginSingleTimeCommands()
     return commandBuffer;
 }
 
-void Renderer::Vulkan::RenderCommand::endSingleTimeCommands(vk::CommandBuffer commandBuffer)
+void Renderer::Vulkan::RenderCommand::submitAndWait(vk::CommandBuffer commandBuffer)
 {
     commandBuffer.end();
 
@@ -39,5 +72,44 @@ void Renderer::Vulkan::RenderCommand::endSingleTimeCommands(vk::CommandBuffer co
     m_sGraphicsQueue->submit(submitInfo);
     m_sGraphicsQueue->waitIdle();
 
+    //everything staged for these commands has been consumed
+    m_sStagingPool->retire(vk::Fence());
+
     m_sDevice->freeCommandBuffers(*m_sCommandPool, 1, &commandBuffer);
 }
+
+void Renderer::Vulkan::RenderCommand::beginBatch()
+{
+    m_sBatchDepth++;
+}
+
+uint32_t Renderer::Vulkan::RenderCommand::endBatch()
+{
+    //nested batches are folded into the outermost one
+    if(m_sBatchDepth == 0 || --m_sBatchDepth > 0)
+        return 0;
+
+    uint32_t savedSubmits = m_sBatchedCommands > 1 ? m_sBatchedCommands - 1 : 0;
+
+    if(m_sBatchCommandBuffer)
+    {
+        submitAndWait(m_sBatchCommandBuffer);
+        m_sBatchCommandBuffer = nullptr;
+    }
+
+    for(auto& func : m_sDeferred)
+        func();
+
+    m_sDeferred.clear();
+    m_sBatchedCommands = 0;
+
+    return savedSubmits;
+}
+
+void Renderer::Vulkan::RenderCommand::deferUntilSubmitted(std::function<void()> func)
+{
+    if(isBatching())
+        m_sDeferred.push_back(std::move(func));
+    else
+        func();
+}
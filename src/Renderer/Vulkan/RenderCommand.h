@@ -2,24 +2,75 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <vector>
+#include <functional>
+
 //this is to be changed
 //bad code
 //and unsafe cos unchecked pointers
 namespace Renderer::Vulkan
 {
+	class StagingPool;
+
 	class RenderCommand
 	{
 	public:
 		RenderCommand() = default;
 
-		static void initRenderCommands(vk::Device& device, vk::CommandPool& commandPool, vk::Queue& graphicsQueue);
+		static void initRenderCommands(vk::Device& device, vk::CommandPool& commandPool, vk::Queue& graphicsQueue, StagingPool& stagingPool);
+
+		//staging memory for single time copies, recycled once the commands using it have been submitted
+		static StagingPool& getStagingPool() { return *m_sStagingPool; }
 
 		static vk::CommandBuffer beginSingleTimeCommands();
 		static void endSingleTimeCommands(vk::CommandBuffer commandBuffer);
 
+		//while a batch is open every single time command records into one command buffer
+		//which is submitted (and waited on) once by endBatch, returns how many submits were saved
+		static void beginBatch();
+		static uint32_t endBatch();
+		static bool isBatching() { return m_sBatchDepth > 0; }
+
+		//runs straight away unless a batch is open, then it runs after the batch has finished on the gpu
+		//used to free staging buffers that the batched commands still read from
+		static void deferUntilSubmitted(std::function<void()> func);
+
 	private:
+		static vk::CommandBuffer allocateAndBegin();
+		static void submitAndWait(vk::CommandBuffer commandBuffer);
+
 		static vk::Device* m_sDevice;
 		static vk::CommandPool* m_sCommandPool;
 		static vk::Queue* m_sGraphicsQueue;
+		static StagingPool* m_sStagingPool;
+
+		static vk::CommandBuffer m_sBatchCommandBuffer;
+		static uint32_t m_sBatchDepth;
+		static uint32_t m_sBatchedCommands;
+		static std::vector<std::function<void()>> m_sDeferred;
+	};
+
+	//scoped init batch, submits on destruction if submit() was not called
+	class InitBatch
+	{
+	public:
+		InitBatch() { RenderCommand::beginBatch(); }
+		~InitBatch() { submit(); }
+
+		InitBatch(const InitBatch&) = delete;
+		InitBatch& operator=(const InitBatch&) = delete;
+
+		uint32_t submit()
+		{
+			if(!m_submitted)
+			{
+				m_savedSubmits = RenderCommand::endBatch();
+				m_submitted = true;
+			}
+			return m_savedSubmits;
+		}
+	private:
+		bool m_submitted = false;
+		uint32_t m_savedSubmits = 0;
 	};
-}
\ No newline at end of file
+}
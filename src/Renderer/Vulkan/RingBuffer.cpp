@@ -0,0 +1,55 @@
+#include "RingBuffer.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+Renderer::Vulkan::RingBuffer::RingBuffer(vk::Device& device, vk::PhysicalDevice& physicalDevice)
+    :m_buffer(device, physicalDevice), m_physicalDevice(physicalDevice)
+{
+}
+
+void Renderer::Vulkan::RingBuffer::create(vk::DeviceSize regionSize, uint32_t frameCount, vk::BufferUsageFlags usage)
+{
+    vk::PhysicalDeviceLimits limits = m_physicalDevice.getProperties().limits;
+
+    //every allocation has to be usable as a descriptor/dynamic offset
+    m_alignment = 1;
+    if(usage & vk::BufferUsageFlagBits::eUniformBuffer)
+        m_alignment = std::max(m_alignment, limits.minUniformBufferOffsetAlignment);
+    if(usage & vk::BufferUsageFlagBits::eStorageBuffer)
+        m_alignment = std::max(m_alignment, limits.minStorageBufferOffsetAlignment);
+
+    m_regionSize = (regionSize + m_alignment - 1) & ~(m_alignment - 1);
+    m_frameCount = frameCount;
+
+    m_buffer.create(static_cast<uint32_t>(m_regionSize * m_frameCount), usage,
+                    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    beginFrame(0);
+}
+
+void Renderer::Vulkan::RingBuffer::free()
+{
+    m_buffer.free();
+    m_regionSize = m_head = m_regionEnd = 0;
+    m_frameCount = 0;
+}
+
+void Renderer::Vulkan::RingBuffer::beginFrame(uint32_t frameIndex)
+{
+    m_head = getRegionOffset(frameIndex);
+    m_regionEnd = m_head + m_regionSize;
+}
+
+Renderer::Vulkan::RingAllocation Renderer::Vulkan::RingBuffer::allocate(vk::DeviceSize size)
+{
+    if(m_head + size > m_regionEnd)
+        throw std::runtime_error("ring buffer region out of space!");
+
+    RingAllocation allocation;
+    allocation.offset = m_head;
+    allocation.data = static_cast<char*>(m_buffer.getMappedData()) + m_head;
+
+    m_head = (m_head + size + m_alignment - 1) & ~(m_alignment - 1);
+    return allocation;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include "Buffer.h"
+
+//persistently mapped buffer split into one region per frame in flight
+//each frame writes into its own region so the cpu never touches memory the gpu is still reading
+namespace Renderer::Vulkan
+{
+	struct RingAllocation
+	{
+		void* data = nullptr;
+		vk::DeviceSize offset = 0; //offset from the start of the whole buffer
+	};
+
+	class RingBuffer
+	{
+	public:
+		RingBuffer(vk::Device& device, vk::PhysicalDevice& physicalDevice);
+
+		void create(vk::DeviceSize regionSize, uint32_t frameCount, vk::BufferUsageFlags usage);
+		void free();
+
+		//resets the write head to the start of the region for this frame
+		void beginFrame(uint32_t frameIndex);
+		RingAllocation allocate(vk::DeviceSize size);
+
+		template<typename T>
+		RingAllocation push(const T& data)
+		{
+			RingAllocation allocation = allocate(sizeof(T));
+			memcpy(allocation.data, &data, sizeof(T));
+			return allocation;
+		}
+
+		vk::Buffer getHandle() const { return m_buffer.getHandle(); }
+		vk::DeviceSize getRegionSize() const { return m_regionSize; }
+		vk::DeviceSize getRegionOffset(uint32_t frameIndex) const { return m_regionSize * frameIndex; }
+		vk::DeviceSize getAlignment() const { return m_alignment; }
+	private:
+		Buffer m_buffer;
+
+		vk::DeviceSize m_regionSize = 0;
+		vk::DeviceSize m_alignment = 1;
+		vk::DeviceSize m_head = 0;
+		vk::DeviceSize m_regionEnd = 0;
+		uint32_t m_frameCount = 0;
+
+		vk::PhysicalDevice& m_physicalDevice;
+	};
+}
@@ -0,0 +1,141 @@
+#include "StagingPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+Renderer::Vulkan::StagingPool::StagingPool(vk::Device& device, vk::PhysicalDevice& physicalDevice)
+    :m_buffer(device, physicalDevice), m_device(device), m_physicalDevice(physicalDevice)
+{
+}
+
+void Renderer::Vulkan::StagingPool::create(vk::DeviceSize capacity)
+{
+    //buffer -> image copies want offsets that are a multiple of the texel size, 16 covers every format we use
+    m_alignment = std::max<vk::DeviceSize>(16, m_physicalDevice.getProperties().limits.optimalBufferCopyOffsetAlignment);
+    m_capacity = capacity;
+    m_head = m_tail = 0;
+
+    m_buffer.create(static_cast<uint32_t>(m_capacity), vk::BufferUsageFlagBits::eTransferSrc,
+                    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+void Renderer::Vulkan::StagingPool::free()
+{
+    //caller is expected to have waited for the device to be idle
+    for(auto& segment : m_segments)
+    {
+        for(auto& buffer : segment.oversized)
+            buffer.free();
+    }
+
+    for(auto& buffer : m_pendingOversized)
+        buffer.free();
+
+    m_segments.clear();
+    m_pendingOversized.clear();
+    m_buffer.free();
+    m_capacity = 0;
+}
+
+Renderer::Vulkan::StagingAllocation Renderer::Vulkan::StagingPool::allocate(vk::DeviceSize size)
+{
+    StagingAllocation allocation;
+
+    if(size <= m_capacity)
+    {
+        uint64_t offset = 0;
+        bool found = tryAllocate(size, offset);
+
+        //free up finished segments, then fall back to waiting on the oldest one
+        if(!found)
+        {
+            reclaim();
+            found = tryAllocate(size, offset);
+        }
+
+        while(!found && !m_segments.empty())
+        {
+            if(m_segments.front().fence)
+                (void)m_device.waitForFences(m_segments.front().fence, VK_TRUE, UINT64_MAX);
+
+            reclaim();
+            found = tryAllocate(size, offset);
+        }
+
+        if(found)
+        {
+            allocation.buffer = m_buffer.getHandle();
+            allocation.offset = offset % m_capacity;
+            allocation.data = static_cast<char*>(m_buffer.getMappedData()) + allocation.offset;
+            return allocation;
+        }
+    }
+
+    //too big for the ring (or the ring is full of work that has not been submitted yet)
+    Buffer oversized(m_device, m_physicalDevice);
+    oversized.create(static_cast<uint32_t>(size), vk::BufferUsageFlagBits::eTransferSrc,
+                     vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    m_pendingOversized.push_back(oversized);
+
+    allocation.buffer = oversized.getHandle();
+    allocation.offset = 0;
+    allocation.data = oversized.getMappedData();
+    return allocation;
+}
+
+Renderer::Vulkan::StagingAllocation Renderer::Vulkan::StagingPool::write(const void* data, vk::DeviceSize size)
+{
+    StagingAllocation allocation = allocate(size);
+    memcpy(allocation.data, data, static_cast<size_t>(size));
+    return allocation;
+}
+
+void Renderer::Vulkan::StagingPool::retire(vk::Fence fence)
+{
+    if(m_head == (m_segments.empty() ? m_tail : m_segments.back().end) && m_pendingOversized.empty())
+        return;
+
+    Segment segment;
+    segment.end = m_head;
+    segment.fence = fence;
+    segment.oversized = std::move(m_pendingOversized);
+    m_pendingOversized.clear();
+
+    m_segments.push_back(std::move(segment));
+
+    if(!fence)
+        reclaim();
+}
+
+void Renderer::Vulkan::StagingPool::reclaim()
+{
+    //segments finish in submission order, stop at the first one still in flight
+    while(!m_segments.empty())
+    {
+        Segment& segment = m_segments.front();
+        if(segment.fence && m_device.getFenceStatus(segment.fence) != vk::Result::eSuccess)
+            break;
+
+        for(auto& buffer : segment.oversized)
+            buffer.free();
+
+        m_tail = segment.end;
+        m_segments.pop_front();
+    }
+}
+
+bool Renderer::Vulkan::StagingPool::tryAllocate(vk::DeviceSize size, uint64_t& offset)
+{
+    uint64_t start = (m_head + m_alignment - 1) & ~(m_alignment - 1);
+
+    //allocations never wrap around the end of the buffer, skip to the start instead
+    if(start % m_capacity + size > m_capacity)
+        start = (start / m_capacity + 1) * m_capacity;
+
+    if(start + size - m_tail > m_capacity)
+        return false;
+
+    offset = start;
+    m_head = start + size;
+    return true;
+}
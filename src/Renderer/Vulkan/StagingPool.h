@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <deque>
+#include <vector>
+
+#include "Buffer.h"
+
+//one big persistently mapped transfer source buffer used as a ring for all cpu -> gpu uploads
+//allocations are grouped into segments by retire(), a segment is reused once its fence has signalled
+namespace Renderer::Vulkan
+{
+	struct StagingAllocation
+	{
+		vk::Buffer buffer;
+		vk::DeviceSize offset = 0;
+		void* data = nullptr;
+	};
+
+	class StagingPool
+	{
+	public:
+		StagingPool(vk::Device& device, vk::PhysicalDevice& physicalDevice);
+
+		void create(vk::DeviceSize capacity);
+		void free();
+
+		//blocks on the oldest segment if the ring is full, uploads bigger than the ring get a temporary buffer
+		StagingAllocation allocate(vk::DeviceSize size);
+		StagingAllocation write(const void* data, vk::DeviceSize size);
+
+		//closes the current segment, it can be reused once fence has signalled
+		//a null fence means the work has already finished. the fence must not be reset before reclaim() has seen it
+		void retire(vk::Fence fence);
+		void reclaim();
+	private:
+		struct Segment
+		{
+			uint64_t end = 0;
+			vk::Fence fence;
+			std::vector<Buffer> oversized;
+		};
+
+		bool tryAllocate(vk::DeviceSize size, uint64_t& offset);
+
+		Buffer m_buffer;
+		vk::DeviceSize m_capacity = 0;
+		vk::DeviceSize m_alignment = 16;
+
+		//virtual offsets that only ever grow, the physical offset is offset % capacity
+		uint64_t m_head = 0;
+		uint64_t m_tail = 0;
+
+		std::deque<Segment> m_segments;
+		std::vector<Buffer> m_pendingOversized;
+
+		vk::Device& m_device;
+		vk::PhysicalDevice& m_physicalDevice;
+	};
+}
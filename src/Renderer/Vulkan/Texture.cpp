@@ -3,6 +3,9 @@
 #include <iostream>
 
 #include "Buffer.h"
+#include "StagingPool.h"
+
+#include "utils/MappedFile.h"
 
 Renderer::Vulkan::Texture::Texture(vk::Device& device, vk::PhysicalDevice& physicalDevice, const std::string& filename)
 	:m_device(device), m_physicalDevice(physicalDevice), m_image(device, physicalDevice)
@@ -11,7 +14,19 @@ Renderer::Vulkan::Texture::Texture(vk::Device& device, vk::PhysicalDevice& physi
 
 bool Renderer::Vulkan::Texture::loadTexture(const std::string& filename)
 {
-    m_pixels = stbi_load("res/textures/test.png", &m_width, &m_height, &m_channels, STBI_rgb_alpha);
+    //decode straight out of the mapped file instead of letting stb do its own reads
+    Utils::FileSpan file;
+    try
+    {
+        file = Utils::mapFile(filename);
+    }
+    catch(const std::exception& e)
+    {
+        std::cout << e.what() << " " << filename << "\n";
+        return false;
+    }
+
+    m_pixels = stbi_load_from_memory(file.bytes(), static_cast<int>(file.size), &m_width, &m_height, &m_channels, STBI_rgb_alpha);
 
     if(!m_pixels)
     {
@@ -29,32 +44,67 @@ void Renderer::Vulkan::Texture::create(const std::string& filename, vk::Filter f
         return;
     }
 
-    //create buffer to store pixels
+    //copy the decoded pixels straight into the shared staging ring
     uint32_t imgSize = m_channels * m_width * m_height;
-    Buffer stagingBuffer(m_device, m_physicalDevice);
-    stagingBuffer.create(imgSize, 
-                         vk::BufferUsageFlagBits::eTransferSrc, 
-                         vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-    //do this because if i pass a std::vector<stbi_uc*>
-    //a stbi_uc** will be uploaded to gpu and this causes the texture data to be a random mess
-    //due to the fact that it is reading a pointer value rather than pixel data
-    std::vector<stbi_uc> pixels(m_pixels, m_pixels + imgSize);
-    stagingBuffer.allocateAndMap<stbi_uc>(pixels);
-
-    //create image
+    StagingAllocation staging = RenderCommand::getStagingPool().write(m_pixels, imgSize);
+
+    createImage();
+
+    //transition layouts and copy buffer data to image
+    m_image.transitionImageLayout(vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
+    m_image.copyFromBuffer(staging.buffer, staging.offset, vk::ImageAspectFlagBits::eColor);
+    m_image.transitionImageLayout(vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    createSampler(filter, addressMode);
+
+    stbi_image_free(m_pixels);
+}
+
+void Renderer::Vulkan::Texture::create(const std::string& filename, vk::Filter filter, vk::SamplerAddressMode addressMode, UploadManager& uploadManager)
+{
+    if(!loadTexture(filename))
+    {
+        std::cout << "failed to load file\n";
+        return;
+    }
+
+    createImage();
+
+    //pixels are copied into staging memory here so they can be freed straight away
+    uint32_t imgSize = m_channels * m_width * m_height;
+    uploadManager.uploadToImage(m_image, m_pixels, imgSize, vk::ImageAspectFlagBits::eColor);
+
+    createSampler(filter, addressMode);
+
+    stbi_image_free(m_pixels);
+}
+
+void Renderer::Vulkan::Texture::create(const void* pixels, uint32_t width, uint32_t height, vk::Filter filter, vk::SamplerAddressMode addressMode, UploadManager& uploadManager)
+{
+    m_width = static_cast<int>(width);
+    m_height = static_cast<int>(height);
+    m_channels = STBI_rgb_alpha;
+
+    createImage();
+
+    uint32_t imgSize = m_channels * m_width * m_height;
+    uploadManager.uploadToImage(m_image, pixels, imgSize, vk::ImageAspectFlagBits::eColor);
+
+    createSampler(filter, addressMode);
+}
+
+void Renderer::Vulkan::Texture::createImage()
+{
     m_image.setSize(m_width, m_height);
     m_image.create(vk::Format::eR8G8B8A8Srgb,
                    vk::ImageTiling::eOptimal,
                    vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
                    vk::MemoryPropertyFlagBits::eDeviceLocal,
                    vk::ImageAspectFlagBits::eColor);
+}
 
-    //transition layouts and copy buffer data to image
-    m_image.transitionImageLayout(vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-    m_image.copyFromBuffer(stagingBuffer, vk::ImageAspectFlagBits::eColor);
-    m_image.transitionImageLayout(vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-
+void Renderer::Vulkan::Texture::createSampler(vk::Filter filter, vk::SamplerAddressMode addressMode)
+{
     vk::PhysicalDeviceProperties properties = m_physicalDevice.getProperties();
 
     //create sampler
@@ -76,7 +126,4 @@ void Renderer::Vulkan::Texture::create(const std::string& filename, vk::Filter f
     samplerInfo.setMaxLod(0.0f);
 
     m_sampler = m_device.createSampler(samplerInfo);
-
-    stbi_image_free(m_pixels);
-    stagingBuffer.free();
 }
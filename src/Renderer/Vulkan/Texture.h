@@ -4,6 +4,7 @@
 #include <string>
 
 #include "Image.h"
+#include "UploadManager.h"
 
 #include<stb_image.h>
 
@@ -15,12 +16,18 @@ namespace Renderer::Vulkan
 		Texture(vk::Device& device, vk::PhysicalDevice& physicalDevice, const std::string& filename = "");
 
 		void create(const std::string& filename, vk::Filter filter, vk::SamplerAddressMode addressMode);
+		//does not wait for the upload, the texture can be sampled once uploadManager has handed it to the graphics queue
+		void create(const std::string& filename, vk::Filter filter, vk::SamplerAddressMode addressMode, UploadManager& uploadManager);
+		//rgba8 pixels generated in memory, same upload path as above
+		void create(const void* pixels, uint32_t width, uint32_t height, vk::Filter filter, vk::SamplerAddressMode addressMode, UploadManager& uploadManager);
 
 		vk::Image getHandle() { return m_image.getHandle(); }
 		vk::ImageView getImageView() { return m_image.getImageView(); }
 		vk::Sampler getSampler() { return m_sampler; }
 	private:
 		bool loadTexture(const std::string& filename);
+		void createImage();
+		void createSampler(vk::Filter filter, vk::SamplerAddressMode addressMode);
 	private:
 		vk::Device& m_device;
 		vk::PhysicalDevice& m_physicalDevice;
@@ -0,0 +1,379 @@
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+//every stage that might read an uploaded resource, used for the acquire side of the transfer
+static const vk::PipelineStageFlags s_consumerStages = vk::PipelineStageFlagBits::eVertexInput
+                                                     | vk::PipelineStageFlagBits::eVertexShader
+                                                     | vk::PipelineStageFlagBits::eFragmentShader
+                                                     | vk::PipelineStageFlagBits::eComputeShader;
+
+static const vk::AccessFlags s_bufferReadAccess = vk::AccessFlagBits::eVertexAttributeRead
+                                                | vk::AccessFlagBits::eIndexRead
+                                                | vk::AccessFlagBits::eUniformRead
+                                                | vk::AccessFlagBits::eShaderRead;
+
+Renderer::Vulkan::UploadManager::UploadManager(vk::Device& device, vk::PhysicalDevice& physicalDevice)
+    :m_stagingPool(device, physicalDevice), m_device(device), m_physicalDevice(physicalDevice)
+{
+}
+
+void Renderer::Vulkan::UploadManager::init(uint32_t transferFamily, vk::Queue transferQueue, uint32_t graphicsFamily, uint32_t framesInFlight, vk::DeviceSize stagingSize)
+{
+    m_transferFamily = transferFamily;
+    m_transferQueue = transferQueue;
+    m_graphicsFamily = graphicsFamily;
+    m_framesInFlight = framesInFlight;
+
+    vk::CommandPoolCreateInfo poolInfo;
+    poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+    poolInfo.setQueueFamilyIndex(m_transferFamily);
+
+    m_commandPool = m_device.createCommandPool(poolInfo);
+    m_stagingPool.create(stagingSize);
+}
+
+void Renderer::Vulkan::UploadManager::free()
+{
+    //caller is expected to have waited for the device to be idle
+    auto destroyBatch = [this](Batch& batch)
+    {
+        m_device.destroyFence(batch.fence);
+        if(batch.semaphore)
+            m_device.destroySemaphore(batch.semaphore);
+        if(batch.queryPool)
+            m_device.destroyQueryPool(batch.queryPool);
+    };
+
+    if(m_isRecording)
+    {
+        m_recording.commandBuffer.end();
+        destroyBatch(m_recording);
+        m_isRecording = false;
+    }
+
+    for(auto& batch : m_submitted)
+        destroyBatch(batch);
+    for(auto& batch : m_freeBatches)
+        destroyBatch(batch);
+
+    m_submitted.clear();
+    m_freeBatches.clear();
+
+    m_stagingPool.free();
+    m_device.destroyCommandPool(m_commandPool);
+}
+
+void Renderer::Vulkan::UploadManager::uploadToBuffer(Buffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset)
+{
+    //the transfer queue may not own an exclusive buffer the graphics queue has used, only a whole write can ignore that
+    bool partial = dstOffset != 0 || size != dst.getSize();
+    if(hasDedicatedTransferQueue() && partial && !dst.isConcurrent())
+        throw std::runtime_error("partial upload into an exclusive buffer, create it with UploadManager::getQueueFamilies()");
+
+    Batch& batch = getRecordingBatch();
+    StagingAllocation staging = m_stagingPool.write(data, size);
+
+    vk::BufferCopy copyRegion;
+    copyRegion.setSrcOffset(staging.offset);
+    copyRegion.setDstOffset(dstOffset);
+    copyRegion.setSize(size);
+    batch.commandBuffer.copyBuffer(staging.buffer, dst.getHandle(), copyRegion);
+
+    //no ownership to hand over, the frame waiting on the batch semaphore makes the copy visible to it
+    if(hasDedicatedTransferQueue() && dst.isConcurrent())
+        return;
+
+    vk::BufferMemoryBarrier barrier;
+    barrier.setBuffer(dst.getHandle());
+    barrier.setOffset(dstOffset);
+    barrier.setSize(size);
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+
+    if(hasDedicatedTransferQueue())
+    {
+        //release on the transfer queue, the matching acquire is recorded by the next frame
+        barrier.setSrcQueueFamilyIndex(m_transferFamily);
+        barrier.setDstQueueFamilyIndex(m_graphicsFamily);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eNone);
+        batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, static_cast<vk::DependencyFlagBits>(0), {}, barrier, {});
+
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eNone);
+        barrier.setDstAccessMask(s_bufferReadAccess);
+        batch.bufferAcquires.push_back(barrier);
+    }
+    else
+    {
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstAccessMask(s_bufferReadAccess);
+        batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, s_consumerStages, static_cast<vk::DependencyFlagBits>(0), {}, barrier, {});
+    }
+}
+
+void Renderer::Vulkan::UploadManager::uploadToImage(Image& dst, const void* data, vk::DeviceSize size, vk::ImageAspectFlagBits aspectFlag)
+{
+    Batch& batch = getRecordingBatch();
+    StagingAllocation staging = m_stagingPool.write(data, size);
+
+    vk::ImageSubresourceRange subresourceRange;
+    subresourceRange.setAspectMask(aspectFlag);
+    subresourceRange.setBaseMipLevel(0);
+    subresourceRange.setLevelCount(1);
+    subresourceRange.setBaseArrayLayer(0);
+    subresourceRange.setLayerCount(1);
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.setImage(dst.getHandle());
+    barrier.setSubresourceRange(subresourceRange);
+    barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    barrier.setOldLayout(vk::ImageLayout::eUndefined);
+    barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eNone);
+    barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+    batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, static_cast<vk::DependencyFlagBits>(0), {}, {}, barrier);
+
+    dst.recordCopyFromBuffer(batch.commandBuffer, staging.buffer, staging.offset, aspectFlag);
+
+    //the layout transition is part of the release/acquire pair so both sides have to specify it
+    barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+    barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+
+    if(hasDedicatedTransferQueue())
+    {
+        barrier.setSrcQueueFamilyIndex(m_transferFamily);
+        barrier.setDstQueueFamilyIndex(m_graphicsFamily);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eNone);
+        batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, static_cast<vk::DependencyFlagBits>(0), {}, {}, barrier);
+
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eNone);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        batch.imageAcquires.push_back(barrier);
+    }
+    else
+    {
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, s_consumerStages, static_cast<vk::DependencyFlagBits>(0), {}, {}, barrier);
+    }
+}
+
+uint64_t Renderer::Vulkan::UploadManager::flush()
+{
+    if(!m_isRecording)
+        return m_nextTicket - 1;
+
+    if(m_recording.queryPool)
+        m_recording.commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_recording.queryPool, 1);
+    m_recording.commandBuffer.end();
+
+    vk::SubmitInfo submitInfo;
+    submitInfo.setCommandBufferCount(1);
+    submitInfo.setPCommandBuffers(&m_recording.commandBuffer);
+
+    if(hasDedicatedTransferQueue())
+    {
+        submitInfo.setSignalSemaphoreCount(1);
+        submitInfo.setPSignalSemaphores(&m_recording.semaphore);
+    }
+    else
+    {
+        //same queue as the frame, the barriers recorded above are enough
+        m_recording.acquired = true;
+    }
+
+    m_transferQueue.submit(submitInfo, m_recording.fence);
+    m_stagingPool.retire(m_recording.fence);
+
+    m_recording.ticket = m_nextTicket++;
+    uint64_t ticket = m_recording.ticket;
+
+    m_submitted.push_back(std::move(m_recording));
+    m_recording = Batch();
+    m_isRecording = false;
+
+    return ticket;
+}
+
+bool Renderer::Vulkan::UploadManager::isComplete(uint64_t ticket)
+{
+    if(ticket <= m_completedTicket)
+        return true;
+    if(ticket >= m_nextTicket)
+        return false;
+
+    for(const auto& batch : m_submitted)
+    {
+        if(batch.ticket <= ticket && m_device.getFenceStatus(batch.fence) != vk::Result::eSuccess)
+            return false;
+    }
+
+    //every batch up to the ticket is done, later calls for it or anything older skip the fence polling
+    m_completedTicket = ticket;
+    return true;
+}
+
+void Renderer::Vulkan::UploadManager::beginFrame()
+{
+    //uploads recorded since the last frame go out now so this frame can acquire them
+    flush();
+
+    m_frameNumber++;
+    collect();
+}
+
+void Renderer::Vulkan::UploadManager::recordAcquireBarriers(vk::CommandBuffer graphicsCommandBuffer)
+{
+    std::vector<vk::BufferMemoryBarrier> bufferBarriers;
+    std::vector<vk::ImageMemoryBarrier> imageBarriers;
+
+    for(auto& batch : m_submitted)
+    {
+        if(batch.acquired)
+            continue;
+
+        bufferBarriers.insert(bufferBarriers.end(), batch.bufferAcquires.begin(), batch.bufferAcquires.end());
+        imageBarriers.insert(imageBarriers.end(), batch.imageAcquires.begin(), batch.imageAcquires.end());
+        batch.acquired = true;
+        batch.acquireFrame = m_frameNumber;
+    }
+
+    if(bufferBarriers.empty() && imageBarriers.empty())
+        return;
+
+    //src stage matches the semaphore wait stage so the acquire is chained after the transfer submission
+    graphicsCommandBuffer.pipelineBarrier(s_consumerStages, s_consumerStages, static_cast<vk::DependencyFlagBits>(0), {}, bufferBarriers, imageBarriers);
+}
+
+bool Renderer::Vulkan::UploadManager::hasPendingAcquires() const
+{
+    for(const auto& batch : m_submitted)
+    {
+        if(!batch.acquired)
+            return true;
+    }
+
+    return false;
+}
+
+void Renderer::Vulkan::UploadManager::getAcquireWaits(std::vector<vk::Semaphore>& waitSemaphores, std::vector<vk::PipelineStageFlags>& waitStages)
+{
+    if(!hasDedicatedTransferQueue())
+        return;
+
+    for(const auto& batch : m_submitted)
+    {
+        if(batch.acquired && batch.acquireFrame == m_frameNumber)
+        {
+            waitSemaphores.push_back(batch.semaphore);
+            waitStages.push_back(s_consumerStages);
+        }
+    }
+}
+
+Renderer::Vulkan::UploadManager::Batch& Renderer::Vulkan::UploadManager::getRecordingBatch()
+{
+    if(m_isRecording)
+        return m_recording;
+
+    if(!m_freeBatches.empty())
+    {
+        m_recording = std::move(m_freeBatches.back());
+        m_freeBatches.pop_back();
+
+        m_device.resetFences(m_recording.fence);
+        m_recording.commandBuffer.reset();
+    }
+    else
+    {
+        vk::CommandBufferAllocateInfo allocInfo;
+        allocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+        allocInfo.setCommandPool(m_commandPool);
+        allocInfo.setCommandBufferCount(1);
+
+        m_recording.commandBuffer = m_device.allocateCommandBuffers(allocInfo)[0];
+        m_recording.fence = m_device.createFence(vk::FenceCreateInfo());
+
+        if(hasDedicatedTransferQueue())
+            m_recording.semaphore = m_device.createSemaphore(vk::SemaphoreCreateInfo());
+    }
+
+    if(m_profiler && !m_recording.queryPool)
+    {
+        vk::QueryPoolCreateInfo queryPoolInfo;
+        queryPoolInfo.setQueryType(vk::QueryType::eTimestamp);
+        queryPoolInfo.setQueryCount(2);
+        m_recording.queryPool = m_device.createQueryPool(queryPoolInfo);
+    }
+
+    //the batch is free, so its previous timestamps have been read and the pool is not in use anymore
+    if(m_recording.queryPool && m_hostQueryReset)
+        m_device.resetQueryPool(m_recording.queryPool, 0, 2);
+
+    vk::CommandBufferBeginInfo beginInfo;
+    beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    m_recording.commandBuffer.begin(beginInfo);
+
+    if(m_recording.queryPool)
+    {
+        if(!m_hostQueryReset)
+            m_recording.commandBuffer.resetQueryPool(m_recording.queryPool, 0, 2);
+        m_recording.commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_recording.queryPool, 0);
+    }
+
+    m_isRecording = true;
+    return m_recording;
+}
+
+void Renderer::Vulkan::UploadManager::collect()
+{
+    //a batch can be reused once the transfer is done and, with a dedicated queue,
+    //the frame that waited on its semaphore is no longer in flight.
+    //batches are recycled in submission order so the staging pool never sees a fence that has been reset
+    while(!m_submitted.empty())
+    {
+        Batch& batch = m_submitted.front();
+
+        if(m_device.getFenceStatus(batch.fence) != vk::Result::eSuccess)
+            break;
+
+        //staging memory only depends on the transfer so it goes back to the ring straight away.
+        //batches leave in submission order, so everything up to this ticket is done
+        m_stagingPool.reclaim();
+        m_completedTicket = std::max(m_completedTicket, batch.ticket);
+
+        bool acquireDone = !hasDedicatedTransferQueue() || (batch.acquired && batch.acquireFrame + m_framesInFlight <= m_frameNumber);
+        if(!acquireDone)
+            break;
+
+        //the fence has signalled so the timestamps are available without waiting
+        double milliseconds = 0.0;
+        if(batch.queryPool && m_profiler->readScope(batch.queryPool, 0, milliseconds))
+            m_profiler->addSample("upload", milliseconds);
+
+        batch.bufferAcquires.clear();
+        batch.imageAcquires.clear();
+        batch.acquired = false;
+
+        m_freeBatches.push_back(std::move(batch));
+        m_submitted.pop_front();
+    }
+}
+
+void Renderer::Vulkan::UploadManager::setProfiler(GpuProfiler* profiler, bool hostQueryReset)
+{
+    m_hostQueryReset = hostQueryReset;
+
+    //vkCmdResetQueryPool needs a graphics or compute queue, a transfer only family has to reset on the host
+    auto queueFlags = m_physicalDevice.getQueueFamilyProperties()[m_transferFamily].queueFlags;
+    bool canReset = m_hostQueryReset || (queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+
+    bool timestamps = profiler && profiler->isEnabled() && GpuProfiler::supportsTimestamps(m_physicalDevice, m_transferFamily);
+    if(timestamps && !canReset)
+        std::cout << "hostQueryReset is not supported, uploads on the transfer only queue are not timed\n";
+    m_profiler = timestamps && canReset ? profiler : nullptr;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+#include <deque>
+
+#include "Buffer.h"
+#include "Image.h"
+#include "StagingPool.h"
+#include "GpuProfiler.h"
+
+//batches cpu -> gpu copies into one command buffer and submits them on the transfer queue without waiting
+//when the device has a transfer only family the resources are released from it and acquired on the graphics
+//queue by the next frame, otherwise everything runs on the graphics queue and a barrier is enough
+namespace Renderer::Vulkan
+{
+	class UploadManager
+	{
+	public:
+		UploadManager(vk::Device& device, vk::PhysicalDevice& physicalDevice);
+
+		void init(uint32_t transferFamily, vk::Queue transferQueue, uint32_t graphicsFamily, uint32_t framesInFlight, vk::DeviceSize stagingSize = 32 * 1024 * 1024);
+		void free();
+
+		//nothing is submitted until flush(), the data is copied into staging memory straight away.
+		//with a dedicated transfer queue an exclusive dst can only be written whole: keeping the rest of its contents
+		//would need the graphics queue to release it first. buffers updated in parts are created with getQueueFamilies()
+		void uploadToBuffer(Buffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset = 0);
+		//dst has to be freshly created (undefined layout), it ends up in shader read only layout
+		void uploadToImage(Image& dst, const void* data, vk::DeviceSize size, vk::ImageAspectFlagBits aspectFlag = vk::ImageAspectFlagBits::eColor);
+
+		//submits the current batch, returns a ticket that can be polled with isComplete
+		uint64_t flush();
+		bool isComplete(uint64_t ticket);
+
+		//renderer side, once per frame: submits pending uploads, reclaims finished batches
+		//and hands submitted ones over to the graphics queue
+		void beginFrame();
+		void recordAcquireBarriers(vk::CommandBuffer graphicsCommandBuffer);
+		//true while a submitted batch still has to be acquired by the graphics queue
+		bool hasPendingAcquires() const;
+		void getAcquireWaits(std::vector<vk::Semaphore>& waitSemaphores, std::vector<vk::PipelineStageFlags>& waitStages);
+
+		bool hasDedicatedTransferQueue() const { return m_transferFamily != m_graphicsFamily; }
+		//for Buffer::create, a concurrent buffer needs no ownership transfers between the upload and the frame
+		std::vector<uint32_t> getQueueFamilies() const { return {m_transferFamily, m_graphicsFamily}; }
+
+		//time every batch on the gpu and report it as "upload", ignored if the transfer family has no timestamps.
+		//hostQueryReset: the device has the feature enabled, needed when the transfer family can not record query resets
+		void setProfiler(GpuProfiler* profiler, bool hostQueryReset);
+	private:
+		struct Batch
+		{
+			vk::CommandBuffer commandBuffer;
+			vk::Fence fence;
+			vk::Semaphore semaphore; //only signalled when there is a dedicated transfer queue
+			vk::QueryPool queryPool; //begin/end timestamps, only with a profiler
+
+			std::vector<vk::BufferMemoryBarrier> bufferAcquires;
+			std::vector<vk::ImageMemoryBarrier> imageAcquires;
+
+			uint64_t ticket = 0;
+			uint64_t acquireFrame = 0;
+			bool acquired = false;
+		};
+
+		Batch& getRecordingBatch();
+		void collect();
+
+		std::deque<Batch> m_submitted;
+		std::vector<Batch> m_freeBatches;
+		Batch m_recording;
+		bool m_isRecording = false;
+
+		StagingPool m_stagingPool;
+		GpuProfiler* m_profiler = nullptr;
+		bool m_hostQueryReset = false; //batch query pools are reset with vkResetQueryPool instead of in the command buffer
+
+		vk::CommandPool m_commandPool;
+		vk::Queue m_transferQueue;
+		uint32_t m_transferFamily = 0;
+		uint32_t m_graphicsFamily = 0;
+
+		uint32_t m_framesInFlight = 1;
+		uint64_t m_frameNumber = 0;
+		uint64_t m_nextTicket = 1;
+		uint64_t m_completedTicket = 0; //every ticket up to this one is known to be complete
+
+		vk::Device& m_device;
+		vk::PhysicalDevice& m_physicalDevice;
+	};
+}
@@ -0,0 +1,212 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+std::string SceneDesc::toString() const
+{
+    std::stringstream stream;
+    stream << "objects: " << objectCount
+           << ", triangles per object: " << trianglesPerObject
+           << ", instances per object: " << instancesPerObject
+           << ", textures: " << textureCount
+           << ", materials: " << materialCount
+           << ", seed: " << seed;
+    return stream.str();
+}
+
+Scene Scene::createDefault()
+{
+    Scene scene;
+    scene.vertices =
+    {
+        {{-0.5f, -0.5f, 0.f}, {1.0f, 0.0f, 1.0f}, {1.f, 0.f}},
+        {{ 0.5f, -0.5f, 0.f}, {1.0f, 0.0f, 1.0f}, {0.f, 0.f}},
+        {{ 0.5f,  0.5f, 0.f}, {0.0f, 0.0f, 1.0f}, {0.f, 1.f}},
+        {{-0.5f,  0.5f, 0.f}, {1.0f, 0.0f, 0.0f}, {1.f, 1.f}},
+
+        {{-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 1.0f}, {1.f, 0.f}},
+        {{ 0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 1.0f}, {0.f, 0.f}},
+        {{ 0.5f,  0.5f, -0.5f}, {0.0f, 0.0f, 1.0f}, {0.f, 1.f}},
+        {{-0.5f,  0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}, {1.f, 1.f}},
+    };
+
+    scene.indices =
+    {
+        0, 1, 2,
+        2, 3, 0,
+
+        4, 5, 6,
+        6, 7, 4,
+    };
+
+    SceneObject object;
+    object.indexCount = static_cast<uint32_t>(scene.indices.size());
+    object.center = glm::vec3(0.f, 0.f, -0.25f);
+    object.radius = glm::length(glm::vec3(0.5f, 0.5f, 0.25f));
+    scene.objects.push_back(object);
+
+    scene.instances.push_back(InstanceData());
+
+    return scene;
+}
+
+uint64_t Scene::getTriangleCount() const
+{
+    uint64_t triangles = 0;
+    for(const auto& object : objects)
+        triangles += static_cast<uint64_t>(object.indexCount / 3) * object.instanceCount;
+    return triangles;
+}
+
+glm::vec4 Scene::getObjectBounds(const SceneObject& object) const
+{
+    if(object.instanceCount == 0)
+        return glm::vec4(object.center, object.radius);
+
+    //per instance spheres, the radius grows with the largest axis scale of the model matrix
+    std::vector<glm::vec4> spheres(object.instanceCount);
+    glm::vec3 center(0.f);
+    for(uint32_t i = 0; i < object.instanceCount; i++)
+    {
+        glm::mat4 model = object.model * instances[object.firstInstance + i].model;
+        float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+        spheres[i] = glm::vec4(glm::vec3(model * glm::vec4(object.center, 1.f)), object.radius * scale);
+        center += glm::vec3(spheres[i]);
+    }
+    center /= static_cast<float>(object.instanceCount);
+
+    //not the tightest sphere, but it contains all of them
+    float radius = 0.f;
+    for(const auto& sphere : spheres)
+        radius = std::max(radius, glm::length(glm::vec3(sphere) - center) + sphere.w);
+
+    return glm::vec4(center, radius);
+}
+
+Scene Scene::generate(const SceneDesc& desc)
+{
+    Scene scene;
+    scene.textureCount = std::max(1u, desc.textureCount);
+    scene.materialCount = std::max(1u, desc.materialCount);
+
+    //tint by material so state changes are visible, the fragment shaders read it from the material blocks
+    scene.materialColors.clear();
+    for(uint32_t i = 0; i < scene.materialCount; i++)
+    {
+        float hue = static_cast<float>(i) / static_cast<float>(scene.materialCount);
+        scene.materialColors.emplace_back(0.5f + 0.5f * std::cos(6.2831f * hue), 0.5f + 0.5f * std::cos(6.2831f * (hue + 0.33f)), 0.5f + 0.5f * std::cos(6.2831f * (hue + 0.67f)), 1.f);
+    }
+
+    std::mt19937 random(desc.seed);
+    std::uniform_real_distribution<float> height(-0.25f, 0.25f);
+    std::uniform_int_distribution<uint32_t> texture(0, scene.textureCount - 1);
+    std::uniform_int_distribution<uint32_t> material(0, scene.materialCount - 1);
+
+    //quads per object as a (near) square grid
+    uint32_t quadCount = std::max(1u, (desc.trianglesPerObject + 1) / 2);
+    uint32_t quadsX = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(quadCount))));
+    uint32_t quadsY = (quadCount + quadsX - 1) / quadsX;
+
+    //every instance gets its own cell of a square grid covering [-extent, extent] in x and y
+    const float extent = 1.5f;
+    uint32_t objectCount = std::max(1u, desc.objectCount);
+    uint32_t instanceCount = std::max(1u, desc.instancesPerObject);
+    uint64_t cellCount = static_cast<uint64_t>(objectCount) * instanceCount;
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(cellCount))));
+    float cellSize = 2.f * extent / static_cast<float>(columns);
+    float patchSize = cellSize * 0.8f;
+
+    size_t verticesPerObject = static_cast<size_t>(quadsX + 1) * (quadsY + 1);
+    size_t indicesPerObject = static_cast<size_t>(quadsX) * quadsY * 6;
+    scene.vertices.reserve(verticesPerObject * objectCount);
+    scene.indices.reserve(indicesPerObject * objectCount);
+    scene.objects.reserve(objectCount);
+    scene.instances.reserve(cellCount);
+
+    for(uint32_t i = 0; i < objectCount; i++)
+    {
+        SceneObject object;
+        object.firstIndex = static_cast<uint32_t>(scene.indices.size());
+        object.indexCount = static_cast<uint32_t>(indicesPerObject);
+        object.vertexOffset = static_cast<int32_t>(scene.vertices.size());
+        object.firstInstance = static_cast<uint32_t>(scene.instances.size());
+        object.instanceCount = instanceCount;
+        object.material = material(random);
+        object.texture = texture(random);
+
+        for(uint32_t y = 0; y <= quadsY; y++)
+        {
+            for(uint32_t x = 0; x <= quadsX; x++)
+            {
+                glm::vec2 uv(static_cast<float>(x) / quadsX, static_cast<float>(y) / quadsY);
+
+                Vertex vertex;
+                vertex.position = glm::vec3(uv.x * patchSize, uv.y * patchSize, 0.f);
+                vertex.texCoord = uv;
+                scene.vertices.push_back(vertex);
+            }
+        }
+
+        //same winding as the default quads, indices are relative to vertexOffset
+        for(uint32_t y = 0; y < quadsY; y++)
+        {
+            for(uint32_t x = 0; x < quadsX; x++)
+            {
+                uint32_t v00 = y * (quadsX + 1) + x;
+                uint32_t v10 = v00 + 1;
+                uint32_t v01 = v00 + quadsX + 1;
+                uint32_t v11 = v01 + 1;
+                scene.indices.insert(scene.indices.end(), {v00, v10, v11, v11, v01, v00});
+            }
+        }
+
+        object.center = glm::vec3(patchSize * 0.5f, patchSize * 0.5f, 0.f);
+        object.radius = patchSize * 0.7072f;
+        scene.objects.push_back(object);
+
+        //the mesh is built once at the origin, the instances move it into their cells
+        for(uint32_t j = 0; j < instanceCount; j++)
+        {
+            uint64_t cell = static_cast<uint64_t>(i) * instanceCount + j;
+            glm::vec3 origin(-extent + (static_cast<float>(cell % columns) + 0.1f) * cellSize,
+                             -extent + (static_cast<float>(cell / columns) + 0.1f) * cellSize,
+                             height(random));
+
+            InstanceData instance;
+            instance.model = glm::translate(glm::mat4(1.f), origin);
+            instance.material = object.material;
+            instance.texture = object.texture;
+            scene.instances.push_back(instance);
+        }
+    }
+
+    return scene;
+}
+
+std::vector<uint8_t> Scene::generateTexturePixels(uint32_t index, uint32_t size)
+{
+    std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+
+    //checker size and tint differ per texture so they are easy to tell apart
+    uint32_t checker = std::max(1u, size / (2 + index % 6));
+    uint8_t tint[3] = {static_cast<uint8_t>(64 + (index * 97) % 192), static_cast<uint8_t>(64 + (index * 57) % 192), static_cast<uint8_t>(64 + (index * 31) % 192)};
+
+    for(uint32_t y = 0; y < size; y++)
+    {
+        for(uint32_t x = 0; x < size; x++)
+        {
+            bool light = ((x / checker) + (y / checker)) % 2 == 0;
+            uint8_t* pixel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+            for(int c = 0; c < 3; c++)
+                pixel[c] = light ? tint[c] : static_cast<uint8_t>(tint[c] / 4);
+            pixel[3] = 255;
+        }
+    }
+
+    return pixels;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <glm/glm.hpp>
+
+#include "Vertex.h"
+
+//one instanced drawIndexed out of the scene's shared vertex/index/instance buffers
+struct SceneObject
+{
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	int32_t vertexOffset = 0;
+	uint32_t firstInstance = 0; //into Scene::instances
+	uint32_t instanceCount = 1;
+	uint32_t material = 0; //pipeline permutation, wraps around the permutation count
+	uint32_t texture = 0; //0 = res/textures/test.png, the rest are generated
+	glm::mat4 model = glm::mat4(1.f); //pushed per draw, applied on top of every instance's model matrix
+
+	//object space bounds of the mesh, each instance's model matrix places them in the world
+	glm::vec3 center = glm::vec3(0.f);
+	float radius = 0.f;
+};
+
+//procedural scene sizes for benchmarking
+struct SceneDesc
+{
+	uint32_t objectCount = 1;
+	uint32_t trianglesPerObject = 2; //rounded up to a full grid of quads
+	uint32_t instancesPerObject = 1; //copies of each object's mesh, all drawn by one draw call
+	uint32_t textureCount = 1;
+	uint32_t materialCount = 1;
+	uint32_t seed = 1;
+
+	std::string toString() const;
+};
+
+struct Scene
+{
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<SceneObject> objects;
+	std::vector<InstanceData> instances;
+	std::vector<glm::vec4> materialColors = {glm::vec4(1.f)}; //one per material
+	uint32_t textureCount = 1;
+	uint32_t materialCount = 1;
+
+	//drawn per frame, counting every instance
+	uint64_t getTriangleCount() const;
+	uint64_t getInstanceCount() const { return instances.size(); }
+	//world space sphere around every instance of the object, xyz center w radius
+	glm::vec4 getObjectBounds(const SceneObject& object) const;
+
+	//the two quads the renderer always drew
+	static Scene createDefault();
+	//objects are grids of quads, their instances are laid out on the xy plane in front of the camera
+	static Scene generate(const SceneDesc& desc);
+
+	//rgba8 pixels for generated texture index (1..textureCount-1), a tinted checkerboard
+	static std::vector<uint8_t> generateTexturePixels(uint32_t index, uint32_t size);
+};
@@ -7,7 +7,7 @@
 struct Vertex
 {
 	glm::vec3 position = glm::vec3(0.f);
-	glm::vec3 color = glm::vec3(0.f);
+	glm::vec3 color = glm::vec3(0.f); //not read by the fragment shaders since the material blocks, generated scenes leave it 0
 	glm::vec2 texCoord = glm::vec2(0.f);
 
 	static vk::VertexInputBindingDescription getBindingDescription()
@@ -41,9 +41,31 @@ struct Vertex
 	}
 };
 
+//per instance data, read by shader.vert from a storage buffer with gl_InstanceIndex (std430, 96 bytes)
+struct InstanceData
+{
+	glm::mat4 model = glm::mat4(1.f);
+	glm::vec4 color = glm::vec4(1.f); //unused like Vertex::color, kept so the std430 layout stays as declared
+	uint32_t material = 0;
+	uint32_t texture = 0; //index into the bindless texture array
+	uint32_t padding[2] = {0, 0};
+};
+
+//per frame, everything per object is pushed (ObjectConstants) or in the material buffer (MaterialUniforms)
 struct UniformBufferObject
 {
-	glm::mat4 model;
 	glm::mat4 view;
 	glm::mat4 proj;
+};
+
+//per draw push constants, 64 of the guaranteed 128 bytes
+struct ObjectConstants
+{
+	glm::mat4 model = glm::mat4(1.f);
+};
+
+//one block per material in a single buffer, selected with a dynamic offset instead of a descriptor set per material
+struct MaterialUniforms
+{
+	glm::vec4 color = glm::vec4(1.f);
 };
\ No newline at end of file
@@ -1,13 +1,24 @@
 #include "Application.h"
 
 #include<iostream>
+#include <csignal>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-int main()
+int main(int argc, char** argv)
 {
-    Application app;
+    RenderSettings settings = RenderSettings::fromArgs(argc, argv);
+    std::cout << settings.toString() << "\n";
+
+    //dump frame stats without closing the app: kill -USR1 <pid>, or ctrl+break on windows
+#if defined(SIGUSR1)
+    std::signal(SIGUSR1, [](int){ Utils::FrameStats::requestDump(); });
+#elif defined(SIGBREAK)
+    std::signal(SIGBREAK, [](int){ Utils::FrameStats::requestDump(); });
+#endif
+
+    Application app(settings);
 
     app.update();
     return 0;
@@ -0,0 +1,425 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+static float surfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 size = max - min;
+    return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+//same test and order of operations as FrustumCuller, so both agree on spheres right at a plane
+static bool isSphereVisible(const Utils::Frustum& frustum, const glm::vec4& sphere)
+{
+    for(const auto& plane : frustum.planes)
+    {
+        if((plane.x * sphere.x + plane.y * sphere.y) + (plane.z * sphere.z + plane.w) < -sphere.w)
+            return false;
+    }
+    return true;
+}
+
+void Utils::Bvh::build(const std::vector<glm::vec4>& spheres)
+{
+    uint32_t count = static_cast<uint32_t>(spheres.size());
+
+    m_nodes.clear();
+    m_parents.clear();
+    m_order.resize(count);
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    m_leaves.assign(count, UINT32_MAX);
+
+    if(count > 0)
+    {
+        //a binary tree with single object leaves has 2n - 1 nodes, sah leaves hold more
+        m_nodes.reserve(2 * count);
+        m_parents.reserve(2 * count);
+        buildNode(spheres, 0, count, UINT32_MAX);
+    }
+
+    m_spheres.resize(count);
+    m_slots.resize(count);
+    for(uint32_t slot = 0; slot < count; slot++)
+    {
+        m_spheres[slot] = spheres[m_order[slot]];
+        m_slots[m_order[slot]] = slot;
+    }
+}
+
+uint32_t Utils::Bvh::buildNode(const std::vector<glm::vec4>& spheres, uint32_t begin, uint32_t end, uint32_t parent)
+{
+    uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(Node());
+    m_parents.push_back(parent);
+
+    //bounds of the spheres, and of their centers which is what splits are picked along
+    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+    glm::vec3 centerMin(FLT_MAX), centerMax(-FLT_MAX);
+    for(uint32_t i = begin; i < end; i++)
+    {
+        const glm::vec4& sphere = spheres[m_order[i]];
+        glm::vec3 center(sphere);
+        boundsMin = glm::min(boundsMin, center - sphere.w);
+        boundsMax = glm::max(boundsMax, center + sphere.w);
+        centerMin = glm::min(centerMin, center);
+        centerMax = glm::max(centerMax, center);
+    }
+    m_nodes[index].min = boundsMin;
+    m_nodes[index].max = boundsMax;
+
+    uint32_t count = end - begin;
+    if(count == 1)
+    {
+        makeLeaf(index, begin, end);
+        return index;
+    }
+
+    //binned sah: a split costs one node visit plus each child's objects weighted by the chance of touching the child,
+    //i.e. its surface area relative to this node. keeping the objects in a leaf costs one test each
+    float parentArea = std::max(surfaceArea(boundsMin, boundsMax), FLT_MIN);
+    float bestCost = static_cast<float>(count);
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+
+    auto getBin = [&](const glm::vec4& sphere, int axis)
+    {
+        float scale = s_binCount / (centerMax[axis] - centerMin[axis]);
+        return std::min(s_binCount - 1, static_cast<uint32_t>((sphere[axis] - centerMin[axis]) * scale));
+    };
+
+    for(int axis = 0; axis < 3; axis++)
+    {
+        if(centerMax[axis] <= centerMin[axis])
+            continue;
+
+        struct Bin
+        {
+            glm::vec3 min = glm::vec3(FLT_MAX);
+            glm::vec3 max = glm::vec3(-FLT_MAX);
+            uint32_t count = 0;
+        };
+        Bin bins[s_binCount];
+        for(uint32_t i = begin; i < end; i++)
+        {
+            const glm::vec4& sphere = spheres[m_order[i]];
+            Bin& bin = bins[getBin(sphere, axis)];
+            bin.min = glm::min(bin.min, glm::vec3(sphere) - sphere.w);
+            bin.max = glm::max(bin.max, glm::vec3(sphere) + sphere.w);
+            bin.count++;
+        }
+
+        //sweep in from both ends, split s puts bins [0, s) on the left and [s, binCount) on the right
+        float rightArea[s_binCount] = {};
+        uint32_t rightCount[s_binCount] = {};
+        glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+        uint32_t sideCount = 0;
+        for(uint32_t split = s_binCount - 1; split > 0; split--)
+        {
+            min = glm::min(min, bins[split].min);
+            max = glm::max(max, bins[split].max);
+            sideCount += bins[split].count;
+            rightArea[split] = sideCount > 0 ? surfaceArea(min, max) : 0.f;
+            rightCount[split] = sideCount;
+        }
+
+        min = glm::vec3(FLT_MAX);
+        max = glm::vec3(-FLT_MAX);
+        sideCount = 0;
+        for(uint32_t split = 1; split < s_binCount; split++)
+        {
+            min = glm::min(min, bins[split - 1].min);
+            max = glm::max(max, bins[split - 1].max);
+            sideCount += bins[split - 1].count;
+            if(sideCount == 0 || rightCount[split] == 0)
+                continue;
+
+            float cost = 1.f + (surfaceArea(min, max) * sideCount + rightArea[split] * rightCount[split]) / parentArea;
+            if(cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t middle;
+    if(bestAxis >= 0)
+    {
+        auto split = std::partition(m_order.begin() + begin, m_order.begin() + end,
+            [&](uint32_t object){ return getBin(spheres[object], bestAxis) < bestSplit; });
+        middle = static_cast<uint32_t>(split - m_order.begin());
+    }
+    else if(count <= s_maxLeafSize)
+    {
+        makeLeaf(index, begin, end);
+        return index;
+    }
+    else
+    {
+        //sah found nothing cheaper than a leaf (or every center is the same point), halve along the longest axis
+        //anyway so leaves stay small
+        glm::vec3 extent = centerMax - centerMin;
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        middle = begin + count / 2;
+        std::nth_element(m_order.begin() + begin, m_order.begin() + middle, m_order.begin() + end,
+            [&](uint32_t a, uint32_t b){ return spheres[a][axis] < spheres[b][axis]; });
+    }
+
+    //the first child always directly follows its parent
+    buildNode(spheres, begin, middle, index);
+    uint32_t second = buildNode(spheres, middle, end, index);
+    m_nodes[index].offset = second;
+    m_nodes[index].count = 0;
+    return index;
+}
+
+void Utils::Bvh::makeLeaf(uint32_t node, uint32_t begin, uint32_t end)
+{
+    m_nodes[node].offset = begin;
+    m_nodes[node].count = end - begin;
+    for(uint32_t slot = begin; slot < end; slot++)
+        m_leaves[m_order[slot]] = node;
+}
+
+bool Utils::Bvh::fitNode(uint32_t index)
+{
+    Node& node = m_nodes[index];
+
+    glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+    if(node.count > 0)
+    {
+        for(uint32_t slot = node.offset; slot < node.offset + node.count; slot++)
+        {
+            const glm::vec4& sphere = m_spheres[slot];
+            min = glm::min(min, glm::vec3(sphere) - sphere.w);
+            max = glm::max(max, glm::vec3(sphere) + sphere.w);
+        }
+    }
+    else
+    {
+        const Node& first = m_nodes[index + 1];
+        const Node& second = m_nodes[node.offset];
+        min = glm::min(first.min, second.min);
+        max = glm::max(first.max, second.max);
+    }
+
+    if(min == node.min && max == node.max)
+        return false;
+
+    node.min = min;
+    node.max = max;
+    return true;
+}
+
+void Utils::Bvh::refit(uint32_t object, const glm::vec4& sphere)
+{
+    m_spheres[m_slots[object]] = sphere;
+
+    //nodes further up only change if the one below them did
+    uint32_t node = m_leaves[object];
+    while(node != UINT32_MAX && fitNode(node))
+        node = m_parents[node];
+}
+
+void Utils::Bvh::refit(const std::vector<glm::vec4>& spheres)
+{
+    if(spheres.size() != m_spheres.size())
+    {
+        build(spheres);
+        return;
+    }
+
+    for(uint32_t slot = 0; slot < m_spheres.size(); slot++)
+        m_spheres[slot] = spheres[m_order[slot]];
+
+    //children always come after their parent, so walking backwards fits every child before its parent
+    for(uint32_t node = static_cast<uint32_t>(m_nodes.size()); node > 0; node--)
+        fitNode(node - 1);
+}
+
+void Utils::Bvh::cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+    if(m_nodes.empty())
+        return;
+
+    struct Entry
+    {
+        uint32_t node;
+        bool inside; //an ancestor was already inside every plane
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({0, false});
+
+    while(!stack.empty())
+    {
+        Entry entry = stack.back();
+        stack.pop_back();
+        const Node& node = m_nodes[entry.node];
+
+        if(!entry.inside)
+        {
+            //per plane only two corners matter, the one furthest along its normal and the opposite one.
+            //the first behind the plane puts the whole box outside, the second in front of every plane puts it inside
+            bool outside = false;
+            entry.inside = true;
+            for(const auto& plane : frustum.planes)
+            {
+                glm::vec3 normal(plane);
+                glm::vec3 furthest(normal.x >= 0.f ? node.max.x : node.min.x, normal.y >= 0.f ? node.max.y : node.min.y, normal.z >= 0.f ? node.max.z : node.min.z);
+                glm::vec3 nearest(normal.x >= 0.f ? node.min.x : node.max.x, normal.y >= 0.f ? node.min.y : node.max.y, normal.z >= 0.f ? node.min.z : node.max.z);
+                if(glm::dot(normal, furthest) + plane.w < 0.f)
+                {
+                    outside = true;
+                    break;
+                }
+                if(glm::dot(normal, nearest) + plane.w < 0.f)
+                    entry.inside = false;
+            }
+
+            if(outside)
+                continue;
+        }
+
+        if(node.count == 0)
+        {
+            //second child first so the first, the next node in memory, is visited next
+            stack.push_back({node.offset, entry.inside});
+            stack.push_back({entry.node + 1, entry.inside});
+            continue;
+        }
+
+        for(uint32_t slot = node.offset; slot < node.offset + node.count; slot++)
+        {
+            if(entry.inside || isSphereVisible(frustum, m_spheres[slot]))
+                visible.push_back(m_order[slot]);
+        }
+    }
+}
+
+bool Utils::Bvh::raycast(const glm::vec3& origin, const glm::vec3& direction, RayHit& hit, float maxDistance) const
+{
+    float length = glm::length(direction);
+    if(m_nodes.empty() || length <= 0.f)
+        return false;
+
+    glm::vec3 dir = direction / length;
+    glm::vec3 inverseDir = 1.f / dir;
+    float best = maxDistance;
+    uint32_t bestObject = UINT32_MAX;
+
+    //where the ray enters the node's box (slab test), FLT_MAX if it misses it or only enters past the best hit so far
+    auto enter = [&](const Node& node)
+    {
+        glm::vec3 t0 = (node.min - origin) * inverseDir;
+        glm::vec3 t1 = (node.max - origin) * inverseDir;
+        glm::vec3 entries = glm::min(t0, t1);
+        glm::vec3 exits = glm::max(t0, t1);
+        float entry = std::max({entries.x, entries.y, entries.z, 0.f});
+        float exit = std::min({exits.x, exits.y, exits.z, best});
+        return entry <= exit ? entry : FLT_MAX;
+    };
+
+    struct Entry
+    {
+        uint32_t node;
+        float distance; //where the ray entered the node
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+
+    float rootDistance = enter(m_nodes[0]);
+    if(rootDistance != FLT_MAX)
+        stack.push_back({0, rootDistance});
+
+    while(!stack.empty())
+    {
+        Entry entry = stack.back();
+        stack.pop_back();
+
+        //a closer hit turned up after the node was pushed
+        if(entry.distance > best)
+            continue;
+
+        const Node& node = m_nodes[entry.node];
+        if(node.count == 0)
+        {
+            //nearer child on top, its hits usually let the farther one be skipped
+            Entry first = {entry.node + 1, enter(m_nodes[entry.node + 1])};
+            Entry second = {node.offset, enter(m_nodes[node.offset])};
+            if(first.distance > second.distance)
+                std::swap(first, second);
+
+            if(second.distance != FLT_MAX)
+                stack.push_back(second);
+            if(first.distance != FLT_MAX)
+                stack.push_back(first);
+            continue;
+        }
+
+        for(uint32_t slot = node.offset; slot < node.offset + node.count; slot++)
+        {
+            //closest approach of the ray to the center, then back along the ray to the surface
+            const glm::vec4& sphere = m_spheres[slot];
+            glm::vec3 toCenter = glm::vec3(sphere) - origin;
+            float along = glm::dot(toCenter, dir);
+            float distanceSquared = glm::dot(toCenter, toCenter) - along * along;
+            float radiusSquared = sphere.w * sphere.w;
+            if(distanceSquared > radiusSquared)
+                continue;
+
+            float halfChord = std::sqrt(radiusSquared - distanceSquared);
+            float distance = along - halfChord;
+            if(distance < 0.f)
+            {
+                //behind the origin, or the origin is inside the sphere
+                if(along + halfChord < 0.f)
+                    continue;
+                distance = 0.f;
+            }
+
+            //ties go to the lowest object index so the result does not depend on the tree
+            uint32_t object = m_order[slot];
+            if(distance < best || (distance == best && object < bestObject))
+            {
+                best = distance;
+                bestObject = object;
+            }
+        }
+    }
+
+    if(bestObject == UINT32_MAX)
+        return false;
+
+    hit.object = bestObject;
+    hit.distance = best;
+    return true;
+}
+
+uint32_t Utils::Bvh::getDepth() const
+{
+    if(m_nodes.empty())
+        return 0;
+
+    uint32_t depth = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> stack = {{0, 1}}; //node, its depth
+    while(!stack.empty())
+    {
+        std::pair<uint32_t, uint32_t> entry = stack.back();
+        stack.pop_back();
+        depth = std::max(depth, entry.second);
+
+        const Node& node = m_nodes[entry.first];
+        if(node.count == 0)
+        {
+            stack.push_back({entry.first + 1, entry.second + 1});
+            stack.push_back({node.offset, entry.second + 1});
+        }
+    }
+    return depth;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "FrustumCulling.h"
+
+namespace Utils
+{
+	//nearest object a ray hit
+	struct RayHit
+	{
+		uint32_t object = UINT32_MAX;
+		float distance = 0.f; //along the normalised ray direction
+	};
+
+	//bounding volume hierarchy over object bounding spheres, built with a binned surface area heuristic and
+	//flattened depth first into one node array: an interior node's first child is the next node, so traversal
+	//mostly walks forward through memory, and every subtree's objects sit next to each other
+	class Bvh
+	{
+	public:
+		static constexpr uint32_t s_binCount = 12; //split candidates per axis
+		static constexpr uint32_t s_maxLeafSize = 4; //bigger leaves are always split, smaller ones only if sah says so
+
+		//xyz center, w radius, one per object. adding or removing objects needs a rebuild
+		void build(const std::vector<glm::vec4>& spheres);
+		//moves one object and refits the nodes above it until one does not change. the tree keeps its shape,
+		//so it slowly gets worse as objects move far from where they were built, rebuild once that shows up
+		void refit(uint32_t object, const glm::vec4& sphere);
+		//every object moved, all nodes are refitted bottom up in one pass
+		void refit(const std::vector<glm::vec4>& spheres);
+
+		//indices of every sphere touching the frustum (same test as FrustumCuller). subtrees outside a plane are
+		//skipped, subtrees inside all of them are taken without testing their objects. the order is the tree's
+		void cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+		//nearest sphere hit by origin + t * normalize(direction) with t in [0, maxDistance], the origin can be inside one
+		bool raycast(const glm::vec3& origin, const glm::vec3& direction, RayHit& hit, float maxDistance = FLT_MAX) const;
+
+		uint32_t getObjectCount() const { return static_cast<uint32_t>(m_spheres.size()); }
+		uint32_t getNodeCount() const { return static_cast<uint32_t>(m_nodes.size()); }
+		uint32_t getDepth() const;
+	private:
+		//32 bytes, two per cache line
+		struct Node
+		{
+			glm::vec3 min;
+			uint32_t offset; //interior: second child (the first is the next node), leaf: first slot in m_spheres
+			glm::vec3 max;
+			uint32_t count; //objects in the leaf, 0 for interior nodes
+		};
+
+		//partitions m_order[begin, end) and appends the subtree, returns its root
+		uint32_t buildNode(const std::vector<glm::vec4>& spheres, uint32_t begin, uint32_t end, uint32_t parent);
+		void makeLeaf(uint32_t node, uint32_t begin, uint32_t end);
+		//bounds from the node's spheres or children, false if they did not change
+		bool fitNode(uint32_t node);
+
+		std::vector<Node> m_nodes;
+		std::vector<uint32_t> m_parents; //per node, UINT32_MAX for the root
+		std::vector<glm::vec4> m_spheres; //in tree order so a leaf's spheres are contiguous
+		std::vector<uint32_t> m_order; //tree slot -> object
+		std::vector<uint32_t> m_slots; //object -> tree slot
+		std::vector<uint32_t> m_leaves; //object -> leaf node holding it
+	};
+}
@@ -0,0 +1,145 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+std::atomic<bool> Utils::FrameStats::m_sDumpRequested{false};
+
+Utils::FrameStats::FrameStats()
+    :m_frames(s_capacity)
+{
+}
+
+void Utils::FrameStats::record(const FrameTimings& timings)
+{
+    m_frames[m_frameCount % s_capacity] = timings;
+    m_frameCount++;
+}
+
+std::vector<Utils::FrameTimings> Utils::FrameStats::snapshot() const
+{
+    //oldest frame first
+    uint64_t first = m_frameCount > s_capacity ? m_frameCount - s_capacity : 0;
+
+    std::vector<FrameTimings> frames;
+    frames.reserve(static_cast<size_t>(m_frameCount - first));
+    for(uint64_t frame = first; frame < m_frameCount; frame++)
+        frames.push_back(m_frames[frame % s_capacity]);
+
+    return frames;
+}
+
+static Utils::FrameStats::Percentiles computePercentiles(std::vector<double>& values)
+{
+    Utils::FrameStats::Percentiles percentiles;
+    if(values.empty())
+        return percentiles;
+
+    std::sort(values.begin(), values.end());
+
+    //nearest rank
+    auto at = [&values](double fraction)
+    {
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(index, values.size() - 1)];
+    };
+
+    double sum = 0.0;
+    for(double value : values)
+        sum += value;
+
+    percentiles.min = values.front();
+    percentiles.p50 = at(0.50);
+    percentiles.p95 = at(0.95);
+    percentiles.p99 = at(0.99);
+    percentiles.max = values.back();
+    percentiles.avg = sum / static_cast<double>(values.size());
+    return percentiles;
+}
+
+Utils::FrameStats::Summary Utils::FrameStats::summarize(double bucketWidth, uint32_t bucketCount) const
+{
+    std::vector<FrameTimings> frames = snapshot();
+
+    Summary summary;
+    summary.frameCount = frames.size();
+    summary.histogramBucketWidth = bucketWidth;
+    summary.histogram.assign(std::max(1u, bucketCount), 0);
+
+    std::vector<double> values(frames.size());
+    auto summarizeField = [&](double FrameTimings::* field)
+    {
+        for(size_t i = 0; i < frames.size(); i++)
+            values[i] = frames[i].*field;
+        return computePercentiles(values);
+    };
+
+    summary.frame = summarizeField(&FrameTimings::frame);
+    summary.acquire = summarizeField(&FrameTimings::acquire);
+    summary.fenceWait = summarizeField(&FrameTimings::fenceWait);
+    summary.record = summarizeField(&FrameTimings::record);
+    summary.submit = summarizeField(&FrameTimings::submit);
+
+    for(const auto& timings : frames)
+    {
+        size_t bucket = static_cast<size_t>(std::max(0.0, timings.frame) / bucketWidth);
+        summary.histogram[std::min(bucket, summary.histogram.size() - 1)]++;
+    }
+
+    return summary;
+}
+
+bool Utils::FrameStats::writeCsv(const std::string& filename) const
+{
+    std::ofstream file(filename, std::ios::trunc);
+    if(!file.is_open())
+        return false;
+
+    file << std::fixed << std::setprecision(4);
+    file << "frame,frame_ms,acquire_ms,fence_wait_ms,record_ms,submit_ms\n";
+
+    std::vector<FrameTimings> frames = snapshot();
+    for(size_t i = 0; i < frames.size(); i++)
+    {
+        const auto& timings = frames[i];
+        file << i << ',' << timings.frame << ',' << timings.acquire << ',' << timings.fenceWait << ','
+             << timings.record << ',' << timings.submit << '\n';
+    }
+
+    return file.good();
+}
+
+static void writePercentiles(std::ofstream& file, const char* name, const Utils::FrameStats::Percentiles& percentiles, bool last = false)
+{
+    file << "    \"" << name << "\": {\"min\": " << percentiles.min << ", \"p50\": " << percentiles.p50
+         << ", \"p95\": " << percentiles.p95 << ", \"p99\": " << percentiles.p99
+         << ", \"max\": " << percentiles.max << ", \"avg\": " << percentiles.avg << "}" << (last ? "\n" : ",\n");
+}
+
+bool Utils::FrameStats::writeJson(const std::string& filename) const
+{
+    std::ofstream file(filename, std::ios::trunc);
+    if(!file.is_open())
+        return false;
+
+    Summary summary = summarize();
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n";
+    file << "  \"frames\": " << summary.frameCount << ",\n";
+    file << "  \"ms\": {\n";
+    writePercentiles(file, "frame", summary.frame);
+    writePercentiles(file, "acquire", summary.acquire);
+    writePercentiles(file, "fence_wait", summary.fenceWait);
+    writePercentiles(file, "record", summary.record);
+    writePercentiles(file, "submit", summary.submit, true);
+    file << "  },\n";
+    file << "  \"histogram\": {\"bucket_ms\": " << summary.histogramBucketWidth << ", \"counts\": [";
+    for(size_t i = 0; i < summary.histogram.size(); i++)
+        file << (i ? ", " : "") << summary.histogram[i];
+    file << "]}\n";
+    file << "}\n";
+
+    return file.good();
+}
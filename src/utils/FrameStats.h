@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	//cpu side timings of one frame, all in milliseconds
+	struct FrameTimings
+	{
+		double frame = 0.0; //start of one frame to the start of the next
+		double acquire = 0.0; //acquireNextImageKHR
+		double fenceWait = 0.0; //waiting for the frame slot's previous submission
+		double record = 0.0; //command buffer recording (or picking a cached one)
+		double submit = 0.0; //queue submit + present
+	};
+
+	//fixed size ring of the last s_capacity frames. writes never block or allocate.
+	//not thread safe, recording and reading both happen on the render thread. a dump requested from a signal
+	//handler only sets a flag, the render loop writes the files
+	class FrameStats
+	{
+	public:
+		static constexpr uint32_t s_capacity = 4096;
+
+		struct Percentiles
+		{
+			double min = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0, avg = 0.0;
+		};
+
+		struct Summary
+		{
+			uint64_t frameCount = 0;
+			Percentiles frame, acquire, fenceWait, record, submit;
+			double histogramBucketWidth = 0.0; //ms
+			std::vector<uint32_t> histogram; //frame times, last bucket also counts everything above it
+		};
+
+		FrameStats();
+
+		void record(const FrameTimings& timings);
+		std::vector<FrameTimings> snapshot() const;
+		Summary summarize(double bucketWidth = 0.5, uint32_t bucketCount = 100) const;
+
+		//one row per frame in the ring
+		bool writeCsv(const std::string& filename) const;
+		//summary with percentiles and the frame time histogram
+		bool writeJson(const std::string& filename) const;
+
+		//async signal safe, the render loop picks it up with consumeDumpRequest
+		static void requestDump() { m_sDumpRequested.store(true, std::memory_order_relaxed); }
+		static bool consumeDumpRequest() { return m_sDumpRequested.exchange(false, std::memory_order_relaxed); }
+	private:
+		std::vector<FrameTimings> m_frames; //s_capacity, on the heap since the owner usually lives on the stack
+		uint64_t m_frameCount = 0;
+
+		static std::atomic<bool> m_sDumpRequested;
+	};
+}
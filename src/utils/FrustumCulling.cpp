@@ -0,0 +1,214 @@
+#include "FrustumCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "ThreadPool.h"
+
+#if defined(__AVX2__)
+    #define FRUSTUM_CULLING_AVX2
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define FRUSTUM_CULLING_SSE
+    #include <emmintrin.h>
+#endif
+
+Utils::Frustum Utils::Frustum::fromMatrix(const glm::mat4& viewProjection)
+{
+    //rows of the clip matrix (gribb/hartmann), depth is 0..1 so the near plane is row 2 on its own
+    glm::mat4 rows = glm::transpose(viewProjection);
+
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+
+    for(auto& plane : frustum.planes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        if(length > 0.f)
+            plane /= length;
+    }
+
+    return frustum;
+}
+
+uint32_t Utils::FrustumCuller::getSimdWidth()
+{
+#if defined(FRUSTUM_CULLING_AVX2)
+    return 8;
+#elif defined(FRUSTUM_CULLING_SSE)
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+const char* Utils::FrustumCuller::getInstructionSet()
+{
+#if defined(FRUSTUM_CULLING_AVX2)
+    return "avx2";
+#elif defined(FRUSTUM_CULLING_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
+
+void Utils::FrustumCuller::setSpheres(const std::vector<glm::vec4>& spheres)
+{
+    m_count = static_cast<uint32_t>(spheres.size());
+    size_t padded = (spheres.size() + 7) / 8 * 8;
+
+    //padding spheres have a negative infinite radius and can never be visible
+    m_x.assign(padded, 0.f);
+    m_y.assign(padded, 0.f);
+    m_z.assign(padded, 0.f);
+    m_radius.assign(padded, -FLT_MAX);
+
+    for(size_t i = 0; i < spheres.size(); i++)
+    {
+        m_x[i] = spheres[i].x;
+        m_y[i] = spheres[i].y;
+        m_z[i] = spheres[i].z;
+        m_radius[i] = spheres[i].w;
+    }
+}
+
+void Utils::FrustumCuller::cull(const Frustum& frustum, std::vector<uint32_t>& visible, ThreadPool* pool, uint32_t chunkSize)
+{
+    visible.clear();
+
+    //chunks start on a multiple of 8 so every simd width lines up
+    chunkSize = std::max(8u, chunkSize / 8 * 8);
+    uint32_t chunkCount = (m_count + chunkSize - 1) / chunkSize;
+    if(!pool || chunkCount <= 1)
+    {
+        cullRange(frustum, 0, m_count, visible);
+        return;
+    }
+
+    if(m_chunkVisible.size() < chunkCount)
+        m_chunkVisible.resize(chunkCount);
+
+    //the pool is shared, waiting on the whole pool would also wait for other callers' jobs
+    JobGroup jobs;
+    for(uint32_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        pool->submit(jobs, [this, &frustum, chunk, chunkSize]()
+        {
+            uint32_t begin = chunk * chunkSize;
+            uint32_t end = std::min(m_count, begin + chunkSize);
+            m_chunkVisible[chunk].clear();
+            cullRange(frustum, begin, end, m_chunkVisible[chunk]);
+        });
+    }
+    jobs.wait();
+
+    size_t total = 0;
+    for(uint32_t chunk = 0; chunk < chunkCount; chunk++)
+        total += m_chunkVisible[chunk].size();
+
+    visible.reserve(total);
+    for(uint32_t chunk = 0; chunk < chunkCount; chunk++)
+        visible.insert(visible.end(), m_chunkVisible[chunk].begin(), m_chunkVisible[chunk].end());
+}
+
+void Utils::FrustumCuller::cullScalar(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+    cullRangeScalar(frustum, 0, m_count, visible);
+}
+
+void Utils::FrustumCuller::cullRange(const Frustum& frustum, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible) const
+{
+#if defined(FRUSTUM_CULLING_AVX2)
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for(int p = 0; p < 6; p++)
+    {
+        planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+
+    for(uint32_t i = begin; i < end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&m_x[i]);
+        __m256 y = _mm256_loadu_ps(&m_y[i]);
+        __m256 z = _mm256_loadu_ps(&m_z[i]);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&m_radius[i]));
+
+        //inside or touching every plane: distance >= -radius
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for(int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y)),
+                                            _mm256_add_ps(_mm256_mul_ps(planeZ[p], z), planeW[p]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(inside);
+        for(uint32_t lane = 0; mask != 0; lane++, mask >>= 1)
+        {
+            if((mask & 1) && i + lane < end)
+                visible.push_back(i + lane);
+        }
+    }
+#elif defined(FRUSTUM_CULLING_SSE)
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for(int p = 0; p < 6; p++)
+    {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+
+    for(uint32_t i = begin; i < end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&m_x[i]);
+        __m128 y = _mm_loadu_ps(&m_y[i]);
+        __m128 z = _mm_loadu_ps(&m_z[i]);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_radius[i]));
+
+        //inside or touching every plane: distance >= -radius
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                                         _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for(uint32_t lane = 0; mask != 0; lane++, mask >>= 1)
+        {
+            if((mask & 1) && i + lane < end)
+                visible.push_back(i + lane);
+        }
+    }
+#else
+    cullRangeScalar(frustum, begin, end, visible);
+#endif
+}
+
+void Utils::FrustumCuller::cullRangeScalar(const Frustum& frustum, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible) const
+{
+    for(uint32_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+        for(int p = 0; p < 6 && inside; p++)
+        {
+            const glm::vec4& plane = frustum.planes[p];
+            //same order of operations as the simd paths so both agree on spheres right at a plane
+            inside = (plane.x * m_x[i] + plane.y * m_y[i]) + (plane.z * m_z[i] + plane.w) >= -m_radius[i];
+        }
+
+        if(inside)
+            visible.push_back(i);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Utils
+{
+	class ThreadPool;
+
+	//six normalised planes pointing inwards, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+	struct Frustum
+	{
+		glm::vec4 planes[6];
+
+		//planes of a vulkan clip space matrix (depth 0..1), e.g. proj * view for world space bounds
+		static Frustum fromMatrix(const glm::mat4& viewProjection);
+	};
+
+	//bounding spheres stored as structure of arrays so 8 (avx2) or 4 (sse) objects are tested per iteration,
+	//picked at compile time with a scalar fallback. the visible list always keeps the input order
+	class FrustumCuller
+	{
+	public:
+		//objects tested per iteration by the compiled in instruction set (1, 4 or 8) and its name
+		static uint32_t getSimdWidth();
+		static const char* getInstructionSet();
+
+		//xyz center, w radius
+		void setSpheres(const std::vector<glm::vec4>& spheres);
+		uint32_t getCount() const { return m_count; }
+
+		//indices of every sphere touching the frustum. with a pool the spheres are split into chunks of chunkSize
+		//that run on its workers, each chunk writes its own list and the lists are joined in order afterwards
+		void cull(const Frustum& frustum, std::vector<uint32_t>& visible, ThreadPool* pool = nullptr, uint32_t chunkSize = 16384);
+		//one sphere at a time, the reference the simd path has to match
+		void cullScalar(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+	private:
+		//appends the visible indices in [begin, end), begin has to be a multiple of the simd width
+		void cullRange(const Frustum& frustum, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible) const;
+		void cullRangeScalar(const Frustum& frustum, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible) const;
+
+		//padded up to a multiple of 8 so simd loads never run past the end
+		std::vector<float> m_x;
+		std::vector<float> m_y;
+		std::vector<float> m_z;
+		std::vector<float> m_radius;
+		uint32_t m_count = 0;
+
+		std::vector<std::vector<uint32_t>> m_chunkVisible; //per chunk results, kept to reuse their memory
+	};
+}
@@ -0,0 +1,138 @@
+#include "MappedFile.h"
+
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+Utils::MappedFile::MappedFile(const std::string& filename)
+{
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open file!");
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        throw std::runtime_error("failed to open file!");
+    }
+
+    m_file = file;
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+
+    //empty files can not be mapped
+    if(m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!m_mapping)
+    {
+        CloseHandle(file);
+        throw std::runtime_error("failed to map file!");
+    }
+
+    m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if(!m_data)
+    {
+        CloseHandle(m_mapping);
+        CloseHandle(file);
+        throw std::runtime_error("failed to map file!");
+    }
+}
+
+Utils::MappedFile::~MappedFile()
+{
+    if(m_data)
+        UnmapViewOfFile(m_data);
+    if(m_mapping)
+        CloseHandle(m_mapping);
+    if(m_file)
+        CloseHandle(m_file);
+}
+
+#else
+
+Utils::MappedFile::MappedFile(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("failed to open file!");
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("failed to open file!");
+    }
+
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    //empty files can not be mapped
+    if(m_size > 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("failed to map file!");
+        }
+
+        m_data = static_cast<const char*>(data);
+    }
+
+    //the mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+Utils::MappedFile::~MappedFile()
+{
+    if(m_data)
+        munmap(const_cast<char*>(m_data), m_size);
+}
+
+#endif
+
+static std::mutex s_fileCacheMutex;
+static std::unordered_map<std::string, std::shared_ptr<const Utils::MappedFile>> s_fileCache;
+
+Utils::FileSpan Utils::mapFile(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(s_fileCacheMutex);
+
+    auto it = s_fileCache.find(filename);
+    if(it == s_fileCache.end())
+        it = s_fileCache.emplace(filename, std::make_shared<const MappedFile>(filename)).first;
+
+    FileSpan span;
+    span.file = it->second;
+    span.data = span.file->data();
+    span.size = span.file->size();
+    return span;
+}
+
+void Utils::trimFileCache()
+{
+    std::lock_guard<std::mutex> lock(s_fileCacheMutex);
+
+    for(auto it = s_fileCache.begin(); it != s_fileCache.end();)
+    {
+        //only the cache holds it
+        if(it->second.use_count() == 1)
+            it = s_fileCache.erase(it);
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Utils
+{
+	//read only memory mapping of a whole file, unmapped on destruction
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string& filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* data() const { return m_data; }
+		size_t size() const { return m_size; }
+	private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+
+	//view into a mapped file, keeps the mapping alive for as long as any span references it
+	struct FileSpan
+	{
+		const char* data = nullptr;
+		size_t size = 0;
+		std::shared_ptr<const MappedFile> file;
+
+		const uint8_t* bytes() const { return reinterpret_cast<const uint8_t*>(data); }
+		bool empty() const { return size == 0; }
+	};
+
+	//maps filename on first use and returns the cached mapping afterwards, thread safe
+	//throws if the file can not be opened
+	FileSpan mapFile(const std::string& filename);
+
+	//drops cached mappings that are not referenced by any span
+	void trimFileCache();
+}
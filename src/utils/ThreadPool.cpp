@@ -0,0 +1,98 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+Utils::ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    for(uint32_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+Utils::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobAvailable.notify_all();
+
+    for(auto& thread : m_threads)
+        thread.join();
+}
+
+void Utils::ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push(std::move(job));
+    }
+    m_jobAvailable.notify_one();
+}
+
+void Utils::ThreadPool::submit(JobGroup& group, std::function<void()> job)
+{
+    group.add();
+    submit([&group, job = std::move(job)]
+    {
+        job();
+        group.done();
+    });
+}
+
+void Utils::ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobsDone.wait(lock, [this]{ return m_jobs.empty() && m_activeJobs == 0; });
+}
+
+void Utils::ThreadPool::workerLoop()
+{
+    while(true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobAvailable.wait(lock, [this]{ return m_stopping || !m_jobs.empty(); });
+
+            //drain the queue before stopping so nothing submitted is lost
+            if(m_jobs.empty())
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+            m_activeJobs++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeJobs--;
+            if(m_jobs.empty() && m_activeJobs == 0)
+                m_jobsDone.notify_all();
+        }
+    }
+}
+
+void Utils::JobGroup::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobsDone.wait(lock, [this]{ return m_pending == 0; });
+}
+
+void Utils::JobGroup::add()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending++;
+}
+
+void Utils::JobGroup::done()
+{
+    //notify under the lock, the waiter may destroy the group as soon as it sees zero
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(--m_pending == 0)
+        m_jobsDone.notify_all();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+	//counts the jobs one caller submitted so it can wait for those without waiting on other users of the pool
+	class JobGroup
+	{
+	public:
+		JobGroup() = default;
+		JobGroup(const JobGroup&) = delete;
+		JobGroup& operator=(const JobGroup&) = delete;
+
+		//blocks until every job submitted with this group has finished
+		void wait();
+	private:
+		friend class ThreadPool;
+
+		void add();
+		void done();
+
+		std::mutex m_mutex;
+		std::condition_variable m_jobsDone;
+		uint32_t m_pending = 0;
+	};
+
+	//fixed number of worker threads pulling jobs from a shared queue
+	class ThreadPool
+	{
+	public:
+		//0 picks hardware_concurrency - 1 (at least one worker)
+		explicit ThreadPool(uint32_t threadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void submit(std::function<void()> job);
+		//the group has to outlive the job, wait on it before it goes out of scope
+		void submit(JobGroup& group, std::function<void()> job);
+
+		//blocks until every submitted job has finished, including ones from other callers
+		void wait();
+
+		uint32_t getThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> m_threads;
+		std::queue<std::function<void()>> m_jobs;
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		std::condition_variable m_jobsDone;
+		uint32_t m_activeJobs = 0;
+		bool m_stopping = false;
+	};
+}
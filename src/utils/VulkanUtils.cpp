@@ -1,18 +1,23 @@
 #include "VulkanUtils.h"
 
 #include <set>
+#include <algorithm>
 #include <string>
 #include <stdexcept>
 
 namespace VulkanUtils
 {
 
-    std::vector<const char*> getRequiredExtensions(bool validationLayersEnabled)
+    std::vector<const char*> getRequiredExtensions(bool validationLayersEnabled, bool windowSystem)
     {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        std::vector<const char*> extensions;
 
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        if(windowSystem)
+        {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if(validationLayersEnabled)
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -25,9 +30,9 @@ namespace VulkanUtils
     {
         QueueFamilyIndices indices = findQueueFamilies(device, surface);
         bool extensionsSupported = checkDeviceExtensionSupport(device, deviceExtensions);
-        bool hasSwapChain = false;
+        bool hasSwapChain = !surface;
 
-        if(extensionsSupported)
+        if(extensionsSupported && surface)
         {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device, surface);
             hasSwapChain = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -60,13 +65,18 @@ namespace VulkanUtils
 
         for(const auto& queueFamily : queueFamilies)
         {
-            if(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)
+            if(!indices.graphicsFamily.has_value() && queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)
                 indices.graphicsFamily = i;
 
-            if(device.getSurfaceSupportKHR(i, surface))
+            if(!indices.presentFamily.has_value() && (surface ? device.getSurfaceSupportKHR(i, surface) : indices.graphicsFamily == static_cast<uint32_t>(i)))
                 indices.presentFamily = i;
 
-            if(indices.isComplete())
+            //transfer is implied by graphics/compute, so look for a family that only does transfers
+            if(!indices.transferFamily.has_value() && (queueFamily.queueFlags & vk::QueueFlagBits::eTransfer)
+               && !(queueFamily.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute)))
+                indices.transferFamily = i;
+
+            if(indices.isComplete() && indices.transferFamily.has_value())
                 break;
 
             i++;
@@ -154,14 +164,26 @@ namespace VulkanUtils
         return availableFormats[0];
     }
 
-    vk::PresentModeKHR chooseSwapPresentMode(const std::vector<vk::PresentModeKHR>& availablePresentModes)
+    vk::PresentModeKHR chooseSwapPresentMode(const std::vector<vk::PresentModeKHR>& availablePresentModes, vk::PresentModeKHR preferredMode)
     {
         for(const auto& availablePresentMode : availablePresentModes)
         {
-            if(availablePresentMode == vk::PresentModeKHR::eMailbox)
+            if(availablePresentMode == preferredMode)
                 return availablePresentMode;
         }
-        return vk::PresentModeKHR::eFifo; //better for low energy usage
+        return vk::PresentModeKHR::eFifo; //always supported, better for low energy usage
+    }
+
+    uint32_t chooseSwapImageCount(const vk::SurfaceCapabilitiesKHR& capabilities, uint32_t requestedCount)
+    {
+        uint32_t imageCount = requestedCount > 0 ? requestedCount : capabilities.minImageCount + 1;
+        imageCount = std::max(imageCount, capabilities.minImageCount);
+
+        //0 means no maximum
+        if(capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+            imageCount = capabilities.maxImageCount;
+
+        return imageCount;
     }
 
     vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities, const glm::ivec2& framebufferSize)
@@ -15,6 +15,7 @@ namespace VulkanUtils
 	{
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
+		std::optional<uint32_t> transferFamily; //transfer only family (dma engine), not required
 		bool isComplete();
 	};
 
@@ -25,11 +26,14 @@ namespace VulkanUtils
 		std::vector<vk::PresentModeKHR> presentModes;
 	};
 
-	std::vector<const char*> getRequiredExtensions(bool validationLayersEnabled);
+	//windowSystem = false for headless rendering, glfw is not initialised then
+	std::vector<const char*> getRequiredExtensions(bool validationLayersEnabled, bool windowSystem = true);
 
+	//a null surface skips the present and swap chain checks (headless)
 	bool isDeviceSuitable(vk::PhysicalDevice device, vk::SurfaceKHR surface, const std::vector<const char*> deviceExtensions);
 	bool checkDeviceExtensionSupport(vk::PhysicalDevice device, const std::vector<const char*> deviceExtensions);
 
+	//without a surface the present family is the graphics family, nothing is ever presented
 	QueueFamilyIndices findQueueFamilies(vk::PhysicalDevice device, vk::SurfaceKHR surface);
 	SwapChainSupportDetails querySwapChainSupport(vk::PhysicalDevice device, vk::SurfaceKHR surface);
 
@@ -43,6 +47,8 @@ namespace VulkanUtils
 
 	//swap chain
 	vk::SurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>& availableFormats);
-	vk::PresentModeKHR chooseSwapPresentMode(const std::vector<vk::PresentModeKHR>& availablePresentModes);
+	vk::PresentModeKHR chooseSwapPresentMode(const std::vector<vk::PresentModeKHR>& availablePresentModes, vk::PresentModeKHR preferredMode = vk::PresentModeKHR::eMailbox);
+	//requestedCount 0 = minImageCount + 1
+	uint32_t chooseSwapImageCount(const vk::SurfaceCapabilitiesKHR& capabilities, uint32_t requestedCount);
 	vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities, const glm::ivec2& framebufferSize);
 }
\ No newline at end of file